@@ -0,0 +1,31 @@
+#include "arena.h"
+
+void *Arena::allocate(size_t size, size_t alignment) {
+    if(size > blockSize) {
+        throw std::bad_alloc();
+    }
+    size_t offset = (blockUsed + alignment - 1) & ~(alignment - 1);
+    if(blocks.empty() || offset + size > blockSize) {
+        if(!blocks.empty()) {
+            currentBlock++;
+        }
+        if(currentBlock == blocks.size()) {
+            blocks.push_back(std::unique_ptr<char[]>(new char[blockSize]));
+        }
+        offset = 0;
+    }
+    blockUsed = offset + size;
+    totalUsed += size;
+    return blocks[currentBlock].get() + offset;
+}
+
+// Makes all memory available again without returning the blocks.
+void Arena::reset() {
+    currentBlock = 0;
+    blockUsed = 0;
+    totalUsed = 0;
+}
+
+size_t Arena::bytesUsed() {
+    return totalUsed;
+}
\ No newline at end of file
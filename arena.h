@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for objects that all die together, such as the syntax
+// tree of one class. Objects are never destroyed individually: reset()
+// releases everything at once and keeps the blocks for reuse, so only
+// trivially destructible types may be allocated.
+class Arena {
+
+public:
+    template<class T>
+    T *make() {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        return new(allocate(sizeof(T), alignof(T))) T();
+    }
+    void *allocate(size_t size, size_t alignment);
+    void reset();
+    size_t bytesUsed();
+
+private:
+    static const size_t blockSize = 1 << 16;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t currentBlock = 0;
+    size_t blockUsed = 0;
+    size_t totalUsed = 0;
+
+};
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+// Syntax tree of a class, built by the Parser and walked by the code
+// generators. Nodes live in the Arena of the compilation and are linked
+// into lists through their next pointers. Names, types and constant texts
+// are StringTable ids; a type is either a keyword id (int, char, boolean,
+// void) or the id of a class name. lineNumber is the line of the first
+// token of the node and is used in error messages.
+
+struct Expression;
+struct Statement;
+
+enum TermKind {
+    TERM_INT,
+    TERM_STRING,
+    TERM_KEYWORD,
+    TERM_VARIABLE,
+    TERM_ARRAY,
+    TERM_CALL,
+    TERM_PARENTHESES,
+    TERM_UNARY
+};
+
+enum StatementKind {
+    STMT_LET,
+    STMT_IF,
+    STMT_WHILE,
+    STMT_DO,
+    STMT_RETURN
+};
+
+// An element of an argument list. Only the first argument is always
+// present: the parser accepts empty arguments after a comma, which have
+// a null expression.
+struct ExpressionList {
+    Expression *expression;
+    ExpressionList *next;
+};
+
+// className is 0 for calls without a qualifier, such as "draw()".
+struct SubroutineCall {
+    int className;
+    int name;
+    int lineNumber;
+    ExpressionList *arguments;
+};
+
+// text is the id of the source text of a constant, value the value of an
+// integer constant, keyword the keyword of a keyword constant and name the
+// variable of a variable or array term. symbol is the operator of a unary
+// term, which applies to operand.
+struct Term {
+    TermKind kind;
+    int lineNumber;
+    int text;
+    int value;
+    int keyword;
+    int name;
+    char symbol;
+    Expression *expression;
+    Term *operand;
+    SubroutineCall *call;
+};
+
+struct OperatorTerm {
+    char symbol;
+    Term *term;
+    OperatorTerm *next;
+};
+
+// Jack operators have no precedence, so an expression is a first term
+// followed by operator-term pairs that are applied from left to right.
+struct Expression {
+    Term *term;
+    OperatorTerm *rest;
+};
+
+// value is the assigned value of let, the condition of if and while and
+// the result of return. Expressions are null where the parser accepts an
+// empty expression, as in "return;". hasIndex marks "let a[...] =".
+struct Statement {
+    StatementKind kind;
+    int lineNumber;
+    int name;
+    bool hasIndex;
+    Expression *index;
+    Expression *value;
+    Statement *body;
+    bool hasElse;
+    Statement *elseBody;
+    SubroutineCall *call;
+    Statement *next;
+};
+
+struct Name {
+    int id;
+    int lineNumber;
+    Name *next;
+};
+
+// kind is KW_STATIC, KW_FIELD or KW_VAR.
+struct VarDec {
+    int kind;
+    int type;
+    Name *names;
+    VarDec *next;
+};
+
+struct Parameter {
+    int type;
+    int name;
+    int lineNumber;
+    Parameter *next;
+};
+
+// kind is KW_CONSTRUCTOR, KW_FUNCTION or KW_METHOD.
+struct SubroutineDec {
+    int kind;
+    int returnType;
+    int name;
+    Parameter *parameters;
+    VarDec *locals;
+    Statement *statements;
+    SubroutineDec *next;
+};
+
+struct ClassDec {
+    int name;
+    VarDec *classVars;
+    SubroutineDec *subroutines;
+};
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include "driver.h"
+
+// Benchmark driver: compiles a corpus of Jack classes a number of times and
+// reports throughput and peak memory. Without a corpus directory a
+// synthetic one is generated.
+
+struct BenchOptions {
+    int iterations = 5;
+    int jobCount = 1;
+    int classCount = 64;
+    int methodCount = 60;
+    CompilerOptions compilerOptions;
+    std::string corpusDirectory;
+};
+
+// Writes a class with 20 fields and methodCount methods that use loops,
+// arrays, string constants, calls and nested expressions.
+static void writeSyntheticClass(std::string filename, std::string className, int methodCount) {
+    std::ostringstream out;
+    out << "/** synthetic benchmark class */\n";
+    out << "class " << className << " {\n";
+    out << "    field int f0";
+    for(int i = 1; i < 20; i++) {
+        out << ", f" << i;
+    }
+    out << ";\n    static int s0, s1;\n\n";
+    out << "    constructor " << className << " new() {\n";
+    for(int i = 0; i < 20; i++) {
+        out << "        let f" << i << " = " << i << ";\n";
+    }
+    out << "        return this;\n    }\n\n";
+    for(int m = 0; m < methodCount; m++) {
+        out << "    method int m" << m << "(int a, int b) {\n";
+        out << "        var int i, t, u;\n        var Array arr;\n        var String s;\n";
+        out << "        let arr = Array.new(8);\n        let i = 0;\n";
+        out << "        while (i < 8) {\n";
+        out << "            let arr[i] = (a * i) + f" << m % 20 << " - (b / 2);\n";
+        out << "            let i = i + 1;\n        }\n";
+        out << "        // line comment " << m << "\n";
+        out << "        if (~(a = b) & (f" << m % 20 << " > 3)) {\n";
+        out << "            let t = f" << (m + 1) % 20 << " + arr[3];\n";
+        out << "        } else {\n            let t = -f" << (m + 2) % 20 << ";\n        }\n";
+        out << "        let s = \"value of m" << m << "\";\n";
+        out << "        let u = s.length() + " << className << ".helper(t, 2 * 3);\n";
+        out << "        do arr.dispose();\n";
+        out << "        return t + u + f" << (m + 3) % 20 << ";\n    }\n\n";
+    }
+    out << "    function int helper(int x, int y) {\n        return (x + y) * 2;\n    }\n}\n";
+    std::ofstream stream(filename, std::ios::out | std::ios::trunc);
+    stream << out.str();
+}
+
+static std::string generateCorpus(const BenchOptions &options) {
+    std::string directoryName = "jackc_bench_corpus/";
+    makeDirectory(directoryName.substr(0, directoryName.size() - 1));
+    for(int i = 0; i < options.classCount; i++) {
+        std::string className = "Bench" + std::to_string(i);
+        writeSyntheticClass(directoryName + className + ".jack", className, options.methodCount);
+    }
+    return directoryName;
+}
+
+static long peakRSSKilobytes() {
+#ifdef _WIN32
+    return -1;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#endif
+}
+
+static void printUsage() {
+    std::cout << "Usage: jackc_bench [-n iterations] [-j N] [--classes N] [--methods N] [-O0 | -O1] [--emit=LIST] [--whole-program] [--inline-threshold=N] [--pool-strings] [--cache-dir=DIR] [corpus_directory/]" << std::endl;
+    std::cout << "  Without a corpus directory a synthetic corpus is written to jackc_bench_corpus/." << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+
+    BenchOptions options;
+    for(int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        bool hasValue = i + 1 < argc;
+        if(arg == "-n" && hasValue) {
+            options.iterations = std::max(1, atoi(argv[++i]));
+        } else if(arg == "-j" && hasValue) {
+            options.jobCount = std::max(1, atoi(argv[++i]));
+        } else if(arg == "--classes" && hasValue) {
+            options.classCount = std::max(1, atoi(argv[++i]));
+        } else if(arg == "--methods" && hasValue) {
+            options.methodCount = std::max(0, atoi(argv[++i]));
+        } else if(arg == "-O0") {
+            options.compilerOptions.optimize = false;
+        } else if(arg == "-O1") {
+            options.compilerOptions.optimize = true;
+        } else if(arg == "--whole-program") {
+            options.compilerOptions.wholeProgram = true;
+        } else if(arg.compare(0, 19, "--inline-threshold=") == 0) {
+            options.compilerOptions.inlineThreshold = std::max(0, atoi(arg.c_str() + 19));
+        } else if(arg == "--pool-strings") {
+            options.compilerOptions.poolStrings = true;
+        } else if(arg.compare(0, 12, "--cache-dir=") == 0) {
+            options.compilerOptions.cacheDirectory = arg.substr(12);
+        } else if(arg.compare(0, 7, "--emit=") == 0) {
+            if(!parseEmitList(arg.substr(7), options.compilerOptions)) {
+                printUsage();
+                return 1;
+            }
+        } else if(arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else {
+            options.corpusDirectory = arg;
+        }
+    }
+
+    std::string directoryName = options.corpusDirectory;
+    if(directoryName.empty()) {
+        directoryName = generateCorpus(options);
+    } else if(directoryName.back() != '/' && directoryName.back() != '\\') {
+        directoryName += '/';
+    }
+    std::vector<std::string> filenames = listJackFiles(directoryName);
+    if(filenames.empty()) {
+        std::cout << "No .jack files in " << directoryName << std::endl;
+        return 1;
+    }
+
+    std::ostream discard(nullptr);
+    long long fileCount = 0;
+    long long tokenCount = 0;
+    int errorCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < options.iterations; i++) {
+        BuildSummary summary = compileFiles(filenames, options.jobCount, options.compilerOptions, discard);
+        fileCount += summary.fileCount;
+        tokenCount += summary.tokenCount;
+        errorCount += summary.errorCount;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double seconds = std::max(elapsed.count(), 1e-9);
+
+    std::cout << "corpus:      " << directoryName << " (" << filenames.size() << " files)" << std::endl;
+    std::cout << "iterations:  " << options.iterations << ", jobs: " << options.jobCount << std::endl;
+    std::cout << "time:        " << seconds << " s" << std::endl;
+    std::cout << "files/sec:   " << fileCount / seconds << std::endl;
+    std::cout << "tokens/sec:  " << tokenCount / seconds << std::endl;
+    if(peakRSSKilobytes() >= 0) {
+        std::cout << "peak RSS:    " << peakRSSKilobytes() << " KB" << std::endl;
+    }
+    if(errorCount > 0) {
+        std::cout << "compile errors: " << errorCount << std::endl;
+    }
+
+    return errorCount > 0 ? 1 : 0;
+
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "buildcache.h"
+#include "driver.h"
+
+static unsigned long long fnv1a(const std::string &text, unsigned long long hash) {
+    for(unsigned char c: text) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+BuildCache::BuildCache(std::string directory, const CompilerOptions &options, const ProgramIndex *program): directory(directory) {
+    if(!this->directory.empty() && this->directory.back() != '/' && this->directory.back() != '\\') {
+        this->directory += '/';
+    }
+    makeDirectory(this->directory.substr(0, this->directory.size() - 1));
+    optionsText = std::string(compilerVersion) + (options.optimize ? " O1" : " O0") + " inline" + std::to_string(options.inlineThreshold) + (options.poolStrings ? " pool" : "");
+    if(options.emitVM) {
+        suffixes.push_back(".vm");
+    }
+    if(options.emitXML) {
+        suffixes.push_back(".xml");
+    }
+    if(options.emitTokens) {
+        suffixes.push_back("T.xml");
+    }
+    for(const std::string &suffix: suffixes) {
+        optionsText += " " + suffix;
+    }
+    if(program) {
+        optionsText += "\n" + program->digest();
+    }
+}
+
+// The key is the hex text of both hashes. They differ only in the offset
+// basis, so they are not independent: the key is no stronger than a good
+// 64-bit hash, which is plenty for the classes of a build.
+std::string BuildCache::sourceKey(const std::string &source) {
+    unsigned long long low = fnv1a(source, fnv1a(optionsText, 14695981039346656037ull));
+    unsigned long long high = fnv1a(source, fnv1a(optionsText, 0x6c62272e07bb0142ull));
+    char text[33];
+    std::snprintf(text, sizeof(text), "%016llx%016llx", high, low);
+    return text;
+}
+
+std::string BuildCache::entryPath(const std::string &key) {
+    return directory + key + ".entry";
+}
+
+// An entry holds, for each artifact, its suffix and size on one line
+// followed by its contents. Returns false if there is no complete entry.
+bool BuildCache::restore(const std::string &key, const std::string &outputName) {
+    std::string entry;
+    if(!readFile(entryPath(key), entry)) {
+        return false;
+    }
+    std::vector<std::pair<size_t, size_t>> contents;
+    size_t position = 0;
+    for(const std::string &suffix: suffixes) {
+        size_t lineEnd = entry.find('\n', position);
+        if(lineEnd == std::string::npos) {
+            return false;
+        }
+        std::istringstream header(entry.substr(position, lineEnd - position));
+        std::string entrySuffix;
+        size_t size = 0;
+        if(!(header >> entrySuffix >> size) || entrySuffix != suffix || size > entry.size() - lineEnd - 1) {
+            return false;
+        }
+        contents.push_back({lineEnd + 1, size});
+        position = lineEnd + 1 + size;
+    }
+    for(size_t i = 0; i < suffixes.size(); i++) {
+        if(!writeFile(outputName + suffixes[i], entry.data() + contents[i].first, contents[i].second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BuildCache::store(const std::string &key, const std::string &outputName) {
+    std::string entry;
+    for(const std::string &suffix: suffixes) {
+        std::string contents;
+        if(!readFile(outputName + suffix, contents)) {
+            return;
+        }
+        entry += suffix + " " + std::to_string(contents.size()) + "\n" + contents;
+    }
+    std::ostringstream temporaryName;
+    temporaryName << entryPath(key) << ".tmp" << std::this_thread::get_id() << "-" << std::random_device()();
+    if(!writeFile(temporaryName.str(), entry.data(), entry.size())) {
+        std::remove(temporaryName.str().c_str());
+        return;
+    }
+#ifdef _WIN32
+    std::remove(entryPath(key).c_str());
+#endif
+    if(std::rename(temporaryName.str().c_str(), entryPath(key).c_str()) != 0) {
+        std::remove(temporaryName.str().c_str());
+    }
+}
\ No newline at end of file
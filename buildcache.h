@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "compiler.h"
+
+// Persistent cache of the artifacts of successfully compiled classes.
+// An entry is keyed on two 64-bit FNV-1a hashes, with different offset
+// bases, of the source text, the compiler version and the options that
+// affect the output, and in whole-program mode the signatures of all
+// classes. The key is computed from the same source text that is then
+// compiled, so an entry never holds the output of another version of the
+// file. An entry holds the contents
+// of every selected artifact in a single file, so an entry is either
+// complete or missing. Entries are written to a temporary file and renamed
+// into place, so several workers and processes can share a directory.
+class BuildCache {
+
+public:
+    BuildCache(std::string directory, const CompilerOptions &options, const ProgramIndex *program = nullptr);
+    std::string sourceKey(const std::string &source);
+    bool restore(const std::string &key, const std::string &outputName);
+    void store(const std::string &key, const std::string &outputName);
+
+private:
+    std::string directory;
+    std::string optionsText;
+    std::vector<std::string> suffixes;
+
+    std::string entryPath(const std::string &key);
+
+};
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <exception>
+#include <string>
+
+struct CompileError : public std::exception {
+
+public:
+    CompileError() {}
+    CompileError(std::string msg): message(msg) {}
+    const char *what() const throw() {
+        return message.c_str();
+    }
+
+protected:
+    std::string message;
+
+};
+
+struct SyntaxError : public CompileError {
+public:
+    SyntaxError(std::string msg) {
+        message = msg;
+    }
+};
+
+struct SemanticError : public CompileError {
+public:
+    SemanticError(std::string msg) {
+        message = msg;
+    }
+};
+
+struct NotImplementedError : public CompileError {
+public:
+    NotImplementedError(std::string msg) {
+        message = msg;
+    }
+};
\ No newline at end of file
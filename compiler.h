@@ -1,98 +1,84 @@
 #pragma once
 
 #include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "arena.h"
+#include "compileerror.h"
+#include "compilestats.h"
 #include "tokenizer.h"
+#include "outputbuffer.h"
+#include "programindex.h"
+#include "timing.h"
+#include "vmwriter.h"
 #include "debug.h"
 
-struct SymbolTableEntry {
-    std::string name;
-    std::string type;
-    std::string kind;
-    int index;
-};
-
-struct CompileError : public std::exception {
-
-public:
-    CompileError() {}
-    CompileError(std::string msg): message(msg) {}
-    const char *what() const throw() {
-        return message.c_str();
-    }
+// Changes whenever the generated output changes, so that build cache
+// entries of older versions are not used.
+extern const char *const compilerVersion;
 
-protected:
-    std::string message;
-
-};
-
-struct SyntaxError : public CompileError {
-public:
-    SyntaxError(std::string msg) {
-        message = msg;
-    }
-};
-
-struct SemanticError : public CompileError {
-public:
-    SemanticError(std::string msg) {
-        message = msg;
-    }
-};
-
-struct NotImplementedError : public CompileError {
-public:
-    NotImplementedError(std::string msg) {
-        message = msg;
-    }
+// emitVM, emitXML and emitTokens select the .vm file, the parse tree in
+// .xml and the token list in T.xml. cacheDirectory enables the build
+// cache when it is not empty. wholeProgram compiles a directory in two
+// passes, checking calls against the signatures of all its classes. With
+// optimize, it also inlines leaf subroutines of up to inlineThreshold VM
+// commands at their calls; 0 turns inlining off. timeReport prints the
+// time of each compilation phase per file, and traceFilename names a
+// Chrome trace of the build to write. statsJSON writes the counters of
+// every file and of the build as JSON. poolStrings builds each string
+// literal of a class once instead of at every evaluation.
+struct CompilerOptions {
+    bool optimize = true;
+    bool wholeProgram = false;
+    int inlineThreshold = 8;
+    bool poolStrings = false;
+    bool emitVM = true;
+    bool emitXML = false;
+    bool emitTokens = false;
+    std::string cacheDirectory;
+    bool timeReport = false;
+    std::string traceFilename;
+    bool statsJSON = false;
 };
 
+// Compiles one class file: the tokens are parsed into a syntax tree, from
+// which the XML parse tree and the VM code are generated. VM code is always
+// generated, since that is where semantic errors are found, but only the
+// selected artifacts are written. With a ProgramIndex, calls to classes of
+// the program are checked against their signatures. The phases of the last
+// compile() are timed and its work is counted in stats(). The string table
+// keeps every identifier and string literal the compiler has seen, and
+// stringCount() tells how many that is.
 class Compiler {
 
 public:
-    void compile(std::string outputFilename);
+    Compiler(CompilerOptions options = CompilerOptions(), const ProgramIndex *program = nullptr);
+    bool declare(std::string inputFilename, ProgramIndex &index);
+    bool compile(std::string inputFilename, std::ostream &console = std::cout);
+    bool compileText(std::string inputFilename, const std::string &source, std::ostream &console);
+    bool compileSource(std::string inputFilename, const std::string &source, std::ostream &console, std::vector<std::pair<std::string, std::string>> &outputs);
+    int tokenCount();
+    int stringCount();
+    const PhaseTimer &phaseTimer();
+    const CompileStats &stats();
 
 private:
+    CompilerOptions options;
+    const ProgramIndex *program;
+    StringTable strings;
+    Arena arena;
+    VMWriter vmWriter{strings};
     Tokenizer tokenizer;
-    std::vector<SymbolTableEntry> classSymbolTable;
-    int classFieldCount = 0;
-    int classStaticCount = 0;
-    int subroutineArgCount = 0;
-    int subroutineLocalCount = 0;
-    std::string subroutineKind;
-    std::string subroutineName;
-    std::string className;
-    std::vector<SymbolTableEntry> subroutineSymbolTable;
-    std::string outputXMLFilename;
-    std::string outputVMFilename;
-    double xmlIndentLevel = 0;
-    int runningIndex = 0;
+    OutputBuffer xmlOutput;
+    OutputBuffer tokensOutput;
+    OutputBuffer vmOutput;
+    PhaseTimer timer;
+    CompileStats fileStats;
+    bool outputsInMemory = false;
 
-    void writeXML(std::string line);
-    void writeVM(std::string line);
-    std::string tokenName();
-    int tokenType();
-    std::string eat(bool valid, std::string whatExpected);
-    std::string eatIdentifier();
-    std::string eatType();
-    std::string eatStr(std::string str);
-    SymbolTableEntry findInSymbolTables(std::string name);
-    void compileClass();
-    void compileClassVarDec();
-    void compileSubroutineDec();
-    void addArgument();
-    void compileParameterList();
-    void compileSubroutineBody();
-    void compileVarDec();
-    void compileStatements();
-    void compileLetStatement();
-    void compileIfStatement();
-    void compileWhileStatement();
-    void compileDoStatement();
-    void compileReturnStatement();
-    bool compileExpression();
-    int compileExpressionList();
-    void compileTerm();
-    std::string compileOp();
-    void compileSubroutineCall();
+    bool compileTokens(const std::string &inputFilename, std::ostream &console);
+    void openOutput(OutputBuffer &output, const std::string &filename);
 
-};
+};
\ No newline at end of file
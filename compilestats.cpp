@@ -0,0 +1,71 @@
+#include "compilestats.h"
+#include "timing.h"
+
+static const char *const tokenTypeKeys[] = {"keyword", "symbol", "integerConstant", "stringConstant", "identifier"};
+
+void CompileStats::add(const CompileStats &other) {
+    characters += other.characters;
+    for(int i = 0; i <= TT_IDENTIFIER; i++) {
+        tokens[i] += other.tokens[i];
+    }
+    symbolLookups += other.symbolLookups;
+    for(int i = 0; i < SymbolTableStats::depthCount; i++) {
+        symbolHitsByDepth[i] += other.symbolHitsByDepth[i];
+    }
+    symbolMisses += other.symbolMisses;
+    syntaxErrors += other.syntaxErrors;
+    semanticErrors += other.semanticErrors;
+    for(int i = 0; i <= VM_RETURN; i++) {
+        vmCommands[i] += other.vmCommands[i];
+    }
+    xmlLines += other.xmlLines;
+    bytesWritten += other.bytesWritten;
+}
+
+// The counters of one object, without the braces.
+static void writeCounters(std::ostream &output, const CompileStats &stats, const std::string &indent) {
+    long long tokenTotal = 0;
+    output << indent << "\"characters\": " << stats.characters << ",\n";
+    output << indent << "\"tokens\": {";
+    for(int i = 0; i <= TT_IDENTIFIER; i++) {
+        output << "\"" << tokenTypeKeys[i] << "\": " << stats.tokens[i] << ", ";
+        tokenTotal += stats.tokens[i];
+    }
+    output << "\"total\": " << tokenTotal << "},\n";
+    output << indent << "\"symbolLookups\": {\"total\": " << stats.symbolLookups << ", \"hitsByDepth\": [";
+    for(int i = 0; i < SymbolTableStats::depthCount; i++) {
+        output << (i ? ", " : "") << stats.symbolHitsByDepth[i];
+    }
+    output << "], \"misses\": " << stats.symbolMisses << "},\n";
+    output << indent << "\"errors\": {\"syntax\": " << stats.syntaxErrors << ", \"semantic\": " << stats.semanticErrors << "},\n";
+    long long commandTotal = 0;
+    output << indent << "\"vmCommands\": {";
+    for(int i = 0; i <= VM_RETURN; i++) {
+        output << "\"" << opcodeNames[i] << "\": " << stats.vmCommands[i] << ", ";
+        commandTotal += stats.vmCommands[i];
+    }
+    output << "\"total\": " << commandTotal << "},\n";
+    output << indent << "\"xmlLines\": " << stats.xmlLines << ",\n";
+    output << indent << "\"bytesWritten\": " << stats.bytesWritten << "\n";
+}
+
+// Writes one object per file in the order of the file list and their sum
+// as "build".
+void writeStatsJSON(std::ostream &output, const std::vector<std::string> &filenames, const std::vector<CompileStats> &files) {
+    CompileStats total;
+    int cachedCount = 0;
+    output << "{\n  \"files\": [\n";
+    for(size_t i = 0; i < files.size(); i++) {
+        output << "    {\n      \"file\": " << jsonString(filenames[i]) << ",\n";
+        output << "      \"cached\": " << (files[i].cached ? "true" : "false") << ",\n";
+        writeCounters(output, files[i], "      ");
+        output << "    }" << (i + 1 < files.size() ? "," : "") << "\n";
+        total.add(files[i]);
+        cachedCount += files[i].cached ? 1 : 0;
+    }
+    output << "  ],\n  \"build\": {\n";
+    output << "    \"files\": " << files.size() << ",\n";
+    output << "    \"cachedFiles\": " << cachedCount << ",\n";
+    writeCounters(output, total, "    ");
+    output << "  }\n}" << std::endl;
+}
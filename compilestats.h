@@ -0,0 +1,30 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "symboltable.h"
+#include "tokenizer.h"
+#include "vmwriter.h"
+
+// Counters of one compilation, or the sum over a build. tokens is indexed
+// by TokenType and vmCommands by VMOpcode, counting the commands written
+// to the .vm file. Files restored from the build cache are not compiled
+// and only count as cached.
+struct CompileStats {
+    bool cached = false;
+    long long characters = 0;
+    long long tokens[TT_IDENTIFIER + 1] = {};
+    long long symbolLookups = 0;
+    long long symbolHitsByDepth[SymbolTableStats::depthCount] = {};
+    long long symbolMisses = 0;
+    long long syntaxErrors = 0;
+    long long semanticErrors = 0;
+    long long vmCommands[VM_RETURN + 1] = {};
+    long long xmlLines = 0;
+    long long bytesWritten = 0;
+
+    void add(const CompileStats &other);
+};
+
+void writeStatsJSON(std::ostream &output, const std::vector<std::string> &filenames, const std::vector<CompileStats> &files);
@@ -1,9 +1,7 @@
 #include "debug.h"
 
-int activeDebugPrintLayer = DL_COMPILER;
-
 void debugPrint(std::string str, DebugLayer layer) {
-    if(layer == activeDebugPrintLayer) {
+    if(debugLayerEnabled(layer)) {
         std::cout << str;
         //std::ofstream stream("debug.txt", std::ios_base::app);
         //stream << str.c_str();
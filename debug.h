@@ -10,7 +10,26 @@ enum DebugLayer {
     DL_NONE
 };
 
-extern int activeDebugPrintLayer;
+// Bit mask of the layers that are compiled in, bit n enabling layer n.
+// Diagnostic builds can override it, e.g. -DDEBUG_LAYERS=3 traces both
+// DL_SYMBOLS and DL_COMPILER. Trace calls for disabled layers are removed
+// at compile time and their arguments are never evaluated.
+#ifndef DEBUG_LAYERS
+#ifdef NDEBUG
+#define DEBUG_LAYERS 0
+#else
+#define DEBUG_LAYERS (1 << DL_COMPILER)
+#endif
+#endif
+
+constexpr bool debugLayerEnabled(DebugLayer layer) {
+    return ((DEBUG_LAYERS) & (1 << layer)) != 0;
+}
+
+#define DEBUG_PRINT(str, layer) \
+    do { if(debugLayerEnabled(layer)) { debugPrint((str), (layer)); } } while(0)
+#define DEBUG_PRINT_LINE(str, layer) \
+    do { if(debugLayerEnabled(layer)) { debugPrintLine((str), (layer)); } } while(0)
 
 void debugPrint(std::string str, DebugLayer layer);
 void debugPrintLine(std::string str, DebugLayer layer);
\ No newline at end of file
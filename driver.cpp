@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include "dirent.h"
+#else
+#include <dirent.h>
+#endif
+#include "driver.h"
+#include "buildcache.h"
+#include "compiler.h"
+#include "timing.h"
+#include "vmrunner.h"
+
+static bool endsWith(std::string const &fullString, std::string const &ending) {
+    if(fullString.length() >= ending.length()) {
+        return (0 == fullString.compare(fullString.length() - ending.length(), ending.length(), ending));
+    } else {
+        return false;
+    }
+}
+
+// Creates the directory and any of its parents that do not exist yet.
+void makeDirectory(std::string name) {
+    size_t separator = name.find_first_of("/\\", 1);
+    while(true) {
+        std::string path = name.substr(0, separator);
+#ifdef _WIN32
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), 0755);
+#endif
+        if(separator == std::string::npos) {
+            break;
+        }
+        separator = name.find_first_of("/\\", separator + 1);
+    }
+}
+
+bool readFile(const std::string &filename, std::string &contents) {
+    std::ifstream stream(filename, std::ios::in | std::ios::binary);
+    if(!stream.is_open()) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << stream.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+bool writeFile(const std::string &filename, const char *data, size_t size) {
+    std::ofstream stream(filename, std::ios::out | std::ios::trunc | std::ios::binary);
+    stream.write(data, size);
+    return (bool)stream;
+}
+
+// Selects the artifacts named in a comma-separated list such as "vm,xml".
+// Returns false for an unknown name.
+bool parseEmitList(const std::string &list, CompilerOptions &options) {
+    options.emitVM = false;
+    options.emitXML = false;
+    options.emitTokens = false;
+    std::istringstream stream(list);
+    std::string name;
+    while(std::getline(stream, name, ',')) {
+        if(name == "vm") {
+            options.emitVM = true;
+        } else if(name == "xml") {
+            options.emitXML = true;
+        } else if(name == "tokens") {
+            options.emitTokens = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the .jack files in the directory, sorted by name. directoryName
+// ends with a path separator.
+std::vector<std::string> listJackFiles(std::string directoryName) {
+    DIR *dir;
+    struct dirent *ent;
+    std::vector<std::string> filenames;
+    std::string dirName = directoryName.substr(0, directoryName.size() - 1);
+    if((dir = opendir(dirName.c_str())) != NULL) {
+        while((ent = readdir(dir)) != NULL) {
+            if(ent->d_type == DT_REG && endsWith(ent->d_name, ".jack")) {
+                filenames.push_back(directoryName + ent->d_name);
+            }
+        }
+        closedir(dir);
+    } else {
+        perror("Error");
+    }
+    std::sort(filenames.begin(), filenames.end());
+    return filenames;
+}
+
+// Runs task(i) for every i below count on up to jobCount threads.
+static void runParallel(size_t count, int jobCount, const std::function<void(size_t)> &task) {
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        while(true) {
+            size_t i = next++;
+            if(i >= count) {
+                break;
+            }
+            task(i);
+        }
+    };
+    int threadCount = std::max(1, std::min(jobCount, (int)count));
+    std::vector<std::thread> threads;
+    for(int i = 1; i < threadCount; i++) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for(std::thread &thread: threads) {
+        thread.join();
+    }
+}
+
+// Compiles every file on a pool of worker threads. Console output of each
+// file is buffered and printed in the order of the file list, so the result
+// does not depend on which worker finishes first. With a cache directory,
+// the artifacts of unchanged files are restored from the build cache
+// instead of being compiled. In whole-program mode the signatures and calls
+// of all classes are collected in a first parallel pass, the subroutines
+// reachable from Sys.init and Main.main are marked, and the files are then
+// compiled against them. Every file and compilation phase is timed for the time
+// report and the trace, when they are enabled. Statistics are written to
+// stdout, after the console output.
+BuildSummary compileFiles(const std::vector<std::string> &filenames, int jobCount, CompilerOptions options, std::ostream &console) {
+    double buildStart = wallSeconds();
+    std::unique_ptr<BuildTrace> trace;
+    if(!options.traceFilename.empty()) {
+        trace.reset(new BuildTrace());
+    }
+    std::vector<FileTiming> timings(filenames.size());
+    std::vector<CompileStats> fileStats(filenames.size());
+    double declareWall = 0;
+    std::vector<std::string> outputs(filenames.size());
+    std::vector<bool> finished(filenames.size(), false);
+    size_t nextToPrint = 0;
+    std::mutex outputMutex;
+    BuildSummary summary;
+    summary.fileCount = (int)filenames.size();
+    std::unique_ptr<ProgramIndex> program;
+    if(options.wholeProgram) {
+        program.reset(new ProgramIndex());
+        runParallel(filenames.size(), jobCount, [&](size_t i) {
+            double start = wallSeconds();
+            Compiler compiler(options);
+            compiler.declare(filenames[i], *program);
+            if(trace) {
+                trace->addSpan("declare " + filenames[i].substr(filenames[i].rfind("/") + 1), "declare", start, wallSeconds() - start, filenames[i]);
+            }
+        });
+        program->findReachable({"Sys.init", "Main.main"});
+        declareWall = wallSeconds() - buildStart;
+    }
+    std::unique_ptr<BuildCache> cache;
+    if(!options.cacheDirectory.empty()) {
+        cache.reset(new BuildCache(options.cacheDirectory, options, program.get()));
+    }
+    runParallel(filenames.size(), jobCount, [&](size_t i) {
+        std::ostringstream fileConsole;
+        const std::string &filename = filenames[i];
+        std::string outputName = filename.substr(0, filename.rfind("."));
+        std::string key;
+        bool success = true;
+        int tokenCount = 0;
+        FileTiming &timing = timings[i];
+        timing.name = filename;
+        double start = wallSeconds();
+        double startCPU = threadCPUSeconds();
+        std::string source;
+        if(cache && readFile(filename, source)) {
+            key = cache->sourceKey(source);
+        }
+        if(!key.empty() && cache->restore(key, outputName)) {
+            fileConsole << "Compiling " << filename.substr(filename.rfind("/") + 1) << " (cached)" << std::endl;
+            timing.cached = true;
+            fileStats[i].cached = true;
+        } else {
+            Compiler compiler(options, program.get());
+            success = key.empty() ? compiler.compile(filename, fileConsole) : compiler.compileText(filename, source, fileConsole);
+            tokenCount = compiler.tokenCount();
+            if(success && !key.empty()) {
+                cache->store(key, outputName);
+            }
+            timing.spans = compiler.phaseTimer().spans();
+            fileStats[i] = compiler.stats();
+        }
+        timing.wall = wallSeconds() - start;
+        timing.cpu = threadCPUSeconds() - startCPU;
+        if(trace) {
+            trace->addSpan(filename.substr(filename.rfind("/") + 1), timing.cached ? "cached" : "file", start, timing.wall, filename);
+            for(const PhaseSpan &span: timing.spans) {
+                trace->addSpan(phaseNames[span.phase], "phase", span.start, span.wall, filename);
+            }
+        }
+        std::lock_guard<std::mutex> lock(outputMutex);
+        if(!success) {
+            summary.errorCount++;
+        }
+        summary.tokenCount += tokenCount;
+        outputs[i] = fileConsole.str();
+        finished[i] = true;
+        while(nextToPrint < filenames.size() && finished[nextToPrint]) {
+            console << outputs[nextToPrint] << std::flush;
+            outputs[nextToPrint].clear();
+            nextToPrint++;
+        }
+    });
+    if(options.timeReport) {
+        writeTimeReport(console, timings, declareWall, wallSeconds() - buildStart);
+    }
+    if(options.statsJSON) {
+        writeStatsJSON(std::cout, filenames, fileStats);
+    }
+    if(trace && !trace->write(options.traceFilename)) {
+        console << "Error: cannot write trace " << options.traceFilename << std::endl;
+    }
+    return summary;
+}
+
+// Runs the .vm files written for the given sources in the VM interpreter
+// and writes the profile of the run to report. Output of the program goes
+// to output. Returns false if the program cannot be loaded or fails.
+bool runProgram(const std::vector<std::string> &filenames, long long instructionLimit, std::ostream &output, std::ostream &report) {
+    VMRunner runner(output);
+    try {
+        for(const std::string &filename: filenames) {
+            runner.load(filename.substr(0, filename.rfind(".")) + ".vm");
+        }
+        runner.run(instructionLimit);
+    } catch(const VMError &e) {
+        output << std::flush;
+        report << "Error: " << e.what() << std::endl;
+        return false;
+    }
+    output << std::flush;
+    runner.writeProfile(report, 20);
+    return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "compiler.h"
+
+struct BuildSummary {
+    int fileCount = 0;
+    int errorCount = 0;
+    long long tokenCount = 0;
+};
+
+void makeDirectory(std::string name);
+bool readFile(const std::string &filename, std::string &contents);
+bool writeFile(const std::string &filename, const char *data, size_t size);
+bool parseEmitList(const std::string &list, CompilerOptions &options);
+std::vector<std::string> listJackFiles(std::string directoryName);
+BuildSummary compileFiles(const std::vector<std::string> &filenames, int jobCount, CompilerOptions options = CompilerOptions(), std::ostream &console = std::cout);
+bool runProgram(const std::vector<std::string> &filenames, long long instructionLimit, std::ostream &output = std::cout, std::ostream &report = std::cerr);
\ No newline at end of file
@@ -1,40 +1,152 @@
 #include <iostream>
-#include "dirent.h"
-#include "tokenizer.h"
-#include "Compiler.h"
-#include "debug.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <thread>
+#include "compiler.h"
+#include "driver.h"
+#include "server.h"
 
-bool endsWith(std::string const &fullString, std::string const &ending) {
-    if(fullString.length() >= ending.length()) {
-        return (0 == fullString.compare(fullString.length() - ending.length(), ending.length(), ending));
-    } else {
+void printUsage() {
+    std::cout << "Usage: JackCompiler [run] [-j N] [-O0 | -O1] [--emit=LIST] [--whole-program] [--inline-threshold=N] [--pool-strings] [--cache-dir=DIR] [--time-report] [--trace=FILE] [--stats=json] <file.jack | directory/>" << std::endl;
+    std::cout << "       JackCompiler --server=SOCKET [-O0 | -O1] [--emit=LIST] [--inline-threshold=N] [--pool-strings]" << std::endl;
+    std::cout << "       JackCompiler --client=SOCKET <file.jack | directory/ | --shutdown>" << std::endl;
+    std::cout << "  -j N    compile up to N files in parallel (default: number of hardware threads)" << std::endl;
+    std::cout << "  -O0     write VM code as generated" << std::endl;
+    std::cout << "  -O1     run the peephole optimizer on VM code (default)" << std::endl;
+    std::cout << "  --emit=LIST  comma-separated outputs to write: vm (.vm), xml (parse tree .xml)" << std::endl;
+    std::cout << "               and tokens (token list T.xml); default: vm" << std::endl;
+    std::cout << "  --whole-program  check calls against the subroutines of all classes in the directory;" << std::endl;
+    std::cout << "                   with -O1, leave out subroutines that Sys.init and Main.main cannot reach" << std::endl;
+    std::cout << "  --inline-threshold=N  with --whole-program and -O1, inline calls to leaf subroutines" << std::endl;
+    std::cout << "                        of up to N VM commands (default: 8, 0 disables)" << std::endl;
+    std::cout << "  --pool-strings   build each string literal of a class once and reuse it; only for" << std::endl;
+    std::cout << "                   programs that do not modify string literals" << std::endl;
+    std::cout << "  --cache-dir=DIR  reuse the outputs of unchanged files from the build cache in DIR" << std::endl;
+    std::cout << "  --time-report    print wall and CPU time of each compilation phase per file and in total" << std::endl;
+    std::cout << "  --trace=FILE     write a Chrome trace (chrome://tracing, Perfetto) of files and phases per worker" << std::endl;
+    std::cout << "  --stats=json     write counters per file and for the build as JSON to stdout;" << std::endl;
+    std::cout << "                   compiler messages then go to stderr" << std::endl;
+    std::cout << "  run     compile, then run the program in the VM interpreter and report" << std::endl;
+    std::cout << "          the instructions executed per function on stderr" << std::endl;
+    std::cout << "  --max-instructions=N  stop a run after N instructions (default: 100000000)" << std::endl;
+    std::cout << "  --server=SOCKET  serve compile requests on a Unix domain socket, keeping the outputs" << std::endl;
+    std::cout << "                   of unchanged files in memory" << std::endl;
+    std::cout << "  --client=SOCKET  have the server at SOCKET compile the files; --shutdown stops it" << std::endl;
+}
+
+// Parses the value of a numeric option, which must be a whole number of at
+// most maximum.
+static bool parseNumber(const std::string &text, long long maximum, long long &value) {
+    if(text.empty() || text.size() > 18 || text.find_first_not_of("0123456789") != std::string::npos) {
         return false;
     }
+    value = std::atoll(text.c_str());
+    return value <= maximum;
 }
 
 int main(int argc, char *argv[]) {
 
-    std::string inputName(argv[1]);
-    if(inputName.back() == '/' || inputName.back() == '\\') {
-        DIR *dir;
-        struct dirent *ent;
-        std::string dirName = inputName.substr(0, inputName.size() - 1);
-        if((dir = opendir(dirName.c_str())) != NULL) {
-            while((ent = readdir(dir)) != NULL) {
-                if(ent->d_type == DT_REG && endsWith(ent->d_name, ".jack")) {
-                    Compiler compiler;
-                    compiler.compile(inputName + ent->d_name);
-                }
-            }
-            closedir(dir);
+    int jobCount = std::max(1, (int)std::thread::hardware_concurrency());
+    CompilerOptions options;
+    std::string inputName;
+    bool run = argc > 1 && std::string(argv[1]) == "run";
+    long long instructionLimit = 100000000;
+    std::string serverSocket;
+    std::string clientSocket;
+    bool shutdown = false;
+    for(int i = run ? 2 : 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        long long number = 0;
+        bool valid = true;
+        if(arg == "-j" || arg.compare(0, 2, "-j") == 0) {
+            std::string value = arg != "-j" ? arg.substr(2) : i + 1 < argc ? argv[++i] : "";
+            valid = parseNumber(value, INT_MAX, number);
+            jobCount = (int)std::max(1LL, number);
+        } else if(arg == "-O0") {
+            options.optimize = false;
+        } else if(arg == "-O1") {
+            options.optimize = true;
+        } else if(arg == "--whole-program") {
+            options.wholeProgram = true;
+        } else if(arg.compare(0, 19, "--inline-threshold=") == 0) {
+            valid = parseNumber(arg.substr(19), INT_MAX, number);
+            options.inlineThreshold = (int)number;
+        } else if(arg.compare(0, 19, "--max-instructions=") == 0) {
+            valid = parseNumber(arg.substr(19), LLONG_MAX, number);
+            instructionLimit = std::max(1LL, number);
+        } else if(arg == "--pool-strings") {
+            options.poolStrings = true;
+        } else if(arg == "--time-report") {
+            options.timeReport = true;
+        } else if(arg.compare(0, 8, "--stats=") == 0) {
+            valid = arg.substr(8) == "json";
+            options.statsJSON = true;
+        } else if(arg.compare(0, 8, "--trace=") == 0) {
+            options.traceFilename = arg.substr(8);
+            valid = !options.traceFilename.empty();
+        } else if(arg.compare(0, 9, "--server=") == 0) {
+            serverSocket = arg.substr(9);
+            valid = !serverSocket.empty();
+        } else if(arg.compare(0, 9, "--client=") == 0) {
+            clientSocket = arg.substr(9);
+            valid = !clientSocket.empty();
+        } else if(arg == "--shutdown") {
+            shutdown = true;
+        } else if(arg.compare(0, 12, "--cache-dir=") == 0) {
+            options.cacheDirectory = arg.substr(12);
+            valid = !options.cacheDirectory.empty();
+        } else if(arg.compare(0, 7, "--emit=") == 0) {
+            valid = arg.size() > 7 && parseEmitList(arg.substr(7), options);
+        } else if(arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Error: unknown option " << arg << std::endl;
+            printUsage();
+            return 1;
+        } else if(!inputName.empty()) {
+            std::cerr << "Error: more than one input: " << inputName << " and " << arg << std::endl;
+            printUsage();
+            return 1;
         } else {
-            perror("Error");
+            inputName = arg;
         }
+        if(!valid) {
+            std::cerr << "Error: missing or invalid value for " << arg << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+    if(!serverSocket.empty()) {
+        CompileServer server(options);
+        return server.serve(serverSocket, std::cout) ? 0 : 1;
+    }
+    if(!clientSocket.empty() && shutdown) {
+        return requestShutdown(clientSocket, std::cerr) ? 0 : 1;
+    }
+    if(inputName.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<std::string> filenames;
+    if(inputName.back() == '/' || inputName.back() == '\\') {
+        filenames = listJackFiles(inputName);
     } else {
-        Compiler compiler;
-        compiler.compile(inputName);
+        filenames.push_back(inputName);
+        jobCount = 1;
+    }
+    if(!clientSocket.empty()) {
+        return requestCompile(clientSocket, filenames, std::cout) ? 0 : 1;
+    }
+    if(!run) {
+        return compileFiles(filenames, jobCount, options, options.statsJSON ? std::cerr : std::cout).errorCount > 0 ? 1 : 0;
     }
 
-    return 0;
+    // The program's own output goes to stdout, so compiler messages and
+    // the profile are written to stderr.
+    options.emitVM = true;
+    if(compileFiles(filenames, jobCount, options, std::cerr).errorCount > 0) {
+        return 1;
+    }
+    return runProgram(filenames, instructionLimit) ? 0 : 1;
 
 }
\ No newline at end of file
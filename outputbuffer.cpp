@@ -0,0 +1,59 @@
+#include "outputbuffer.h"
+
+OutputBuffer::~OutputBuffer() {
+    close();
+}
+
+void OutputBuffer::open(std::string filename) {
+    close();
+    inMemory = false;
+    stream.open(filename, std::ios::out | std::ios::trunc);
+    buffer.clear();
+    buffer.reserve(flushThreshold * 2);
+    lines = 0;
+    bytes = 0;
+}
+
+void OutputBuffer::openInMemory() {
+    close();
+    inMemory = true;
+    buffer.clear();
+    lines = 0;
+    bytes = 0;
+}
+
+const std::string &OutputBuffer::contents() {
+    return buffer;
+}
+
+void OutputBuffer::writeLine(const std::string &line) {
+    buffer += line;
+    buffer += '\n';
+    lines++;
+    bytes += line.size() + 1;
+    if(!inMemory && buffer.size() >= flushThreshold) {
+        flush();
+    }
+}
+
+void OutputBuffer::flush() {
+    if(stream.is_open() && !buffer.empty()) {
+        stream.write(buffer.data(), buffer.size());
+    }
+    buffer.clear();
+}
+
+void OutputBuffer::close() {
+    if(stream.is_open()) {
+        flush();
+        stream.close();
+    }
+}
+
+long long OutputBuffer::lineCount() {
+    return lines;
+}
+
+long long OutputBuffer::byteCount() {
+    return bytes;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+// Output file that is opened once and written in large chunks.
+// Lines are appended to an in-memory buffer which goes to disk
+// when it grows past flushThreshold or when the file is closed. The lines
+// and bytes written since the file was opened are counted. A buffer opened
+// with openInMemory() has no file and keeps everything in contents().
+class OutputBuffer {
+
+public:
+    ~OutputBuffer();
+    void open(std::string filename);
+    void openInMemory();
+    const std::string &contents();
+    void writeLine(const std::string &line);
+    void flush();
+    void close();
+    long long lineCount();
+    long long byteCount();
+
+private:
+    static const size_t flushThreshold = 1 << 16;
+    std::ofstream stream;
+    std::string buffer;
+    bool inMemory = false;
+    long long lines = 0;
+    long long bytes = 0;
+
+};
@@ -0,0 +1,350 @@
+#include <cstdlib>
+#include "parser.h"
+
+Parser::Parser(Tokenizer &tokenizer, StringTable &stringTable, Arena &arena): tokenizer(tokenizer), strings(stringTable), arena(arena) {}
+
+std::string Parser::tokenName() {
+    return tokenizer.tokenText(tokenizer.currentToken());
+}
+
+int Parser::tokenType() {
+    return tokenizer.currentToken().type;
+}
+
+int Parser::tokenKeyword() {
+    return tokenizer.currentToken().keyword;
+}
+
+char Parser::tokenSymbol() {
+    return tokenizer.currentToken().symbol;
+}
+
+int Parser::lineNumber() {
+    return tokenizer.currentToken().lineNumber;
+}
+
+int Parser::eat(bool valid, std::string whatExpected) {
+    int result = tokenizer.currentToken().id;
+    if(tokenizer.hasMoreTokens()) {
+        if(valid) {
+            tokenizer.advance();
+        } else {
+            throw SyntaxError(std::string("Line " + std::to_string(lineNumber()) + ": '" + tokenName() + "'" + ": " + whatExpected + " expected").c_str());
+        }
+    } else {
+        throw SyntaxError(std::string(whatExpected + " expected, but file ended").c_str());
+    }
+    return result;
+}
+
+int Parser::eatIdentifier() {
+    return eat(tokenType() == TT_IDENTIFIER, "identifier");
+}
+
+int Parser::eatType() {
+    return eat(tokenKeyword() == KW_INT || tokenKeyword() == KW_CHAR || tokenKeyword() == KW_BOOLEAN || tokenType() == TT_IDENTIFIER, "type");
+}
+
+int Parser::eatKeyword(int keyword) {
+    return eat(tokenKeyword() == keyword, strings.str(keyword));
+}
+
+int Parser::eatSymbol(char symbol) {
+    return eat(tokenSymbol() == symbol, std::string(1, symbol));
+}
+
+ClassDec *Parser::parseClass() {
+    ClassDec *classDec = arena.make<ClassDec>();
+    eatKeyword(KW_CLASS);
+    classDec->name = eatIdentifier();
+    eatSymbol('{');
+    VarDec **classVar = &classDec->classVars;
+    while(tokenKeyword() == KW_STATIC || tokenKeyword() == KW_FIELD) {
+        *classVar = parseClassVarDec();
+        classVar = &(*classVar)->next;
+    }
+    SubroutineDec **subroutine = &classDec->subroutines;
+    while(tokenKeyword() == KW_CONSTRUCTOR || tokenKeyword() == KW_FUNCTION || tokenKeyword() == KW_METHOD) {
+        *subroutine = parseSubroutineDec();
+        subroutine = &(*subroutine)->next;
+    }
+    eatSymbol('}');
+    return classDec;
+}
+
+VarDec *Parser::parseClassVarDec() {
+    VarDec *varDec = arena.make<VarDec>();
+    varDec->kind = eat(tokenKeyword() == KW_STATIC || tokenKeyword() == KW_FIELD, "'static' or 'field'");
+    varDec->type = eatType();
+    varDec->names = parseNames();
+    eatSymbol(';');
+    return varDec;
+}
+
+// One or more identifiers separated by commas.
+Name *Parser::parseNames() {
+    Name *first = nullptr;
+    Name **name = &first;
+    do {
+        if(first) {
+            eatSymbol(',');
+        }
+        *name = arena.make<Name>();
+        (*name)->lineNumber = lineNumber();
+        (*name)->id = eatIdentifier();
+        name = &(*name)->next;
+    } while(tokenSymbol() == ',');
+    return first;
+}
+
+SubroutineDec *Parser::parseSubroutineDec() {
+    SubroutineDec *subroutine = arena.make<SubroutineDec>();
+    subroutine->kind = eat(tokenKeyword() == KW_CONSTRUCTOR || tokenKeyword() == KW_FUNCTION || tokenKeyword() == KW_METHOD, "'constructor', 'function' or 'method'");
+    subroutine->returnType = eat(tokenKeyword() == KW_VOID || tokenKeyword() == KW_INT || tokenKeyword() == KW_CHAR || tokenKeyword() == KW_BOOLEAN || tokenType() == TT_IDENTIFIER, "'void' or type");
+    subroutine->name = eatIdentifier();
+    eatSymbol('(');
+    subroutine->parameters = parseParameterList();
+    eatSymbol(')');
+    eatSymbol('{');
+    VarDec **local = &subroutine->locals;
+    while(tokenKeyword() == KW_VAR) {
+        *local = parseVarDec();
+        local = &(*local)->next;
+    }
+    subroutine->statements = parseStatements();
+    eatSymbol('}');
+    return subroutine;
+}
+
+Parameter *Parser::parseParameter() {
+    Parameter *parameter = arena.make<Parameter>();
+    parameter->type = eatType();
+    parameter->lineNumber = lineNumber();
+    parameter->name = eatIdentifier();
+    return parameter;
+}
+
+Parameter *Parser::parseParameterList() {
+    Parameter *first = nullptr;
+    if(tokenSymbol() != ')') {
+        first = parseParameter();
+        Parameter *last = first;
+        while(tokenSymbol() == ',') {
+            eatSymbol(',');
+            last->next = parseParameter();
+            last = last->next;
+        }
+    }
+    return first;
+}
+
+VarDec *Parser::parseVarDec() {
+    VarDec *varDec = arena.make<VarDec>();
+    varDec->kind = eatKeyword(KW_VAR);
+    varDec->type = eatType();
+    varDec->names = parseNames();
+    eatSymbol(';');
+    return varDec;
+}
+
+Statement *Parser::parseStatements() {
+    Statement *first = nullptr;
+    Statement **statement = &first;
+    while(true) {
+        switch(tokenKeyword()) {
+            case KW_LET:    *statement = parseLetStatement();       break;
+            case KW_IF:     *statement = parseIfStatement();        break;
+            case KW_WHILE:  *statement = parseWhileStatement();     break;
+            case KW_DO:     *statement = parseDoStatement();        break;
+            case KW_RETURN: *statement = parseReturnStatement();    break;
+            default:        return first;
+        }
+        statement = &(*statement)->next;
+    }
+}
+
+Statement *Parser::parseLetStatement() {
+    Statement *statement = arena.make<Statement>();
+    statement->kind = STMT_LET;
+    statement->lineNumber = lineNumber();
+    eatKeyword(KW_LET);
+    statement->name = eatIdentifier();
+    if(tokenSymbol() == '[') {
+        eatSymbol('[');
+        statement->hasIndex = true;
+        statement->index = parseExpression();
+        eatSymbol(']');
+    }
+    eatSymbol('=');
+    statement->value = parseExpression();
+    eatSymbol(';');
+    return statement;
+}
+
+Statement *Parser::parseIfStatement() {
+    Statement *statement = arena.make<Statement>();
+    statement->kind = STMT_IF;
+    statement->lineNumber = lineNumber();
+    eatKeyword(KW_IF);
+    eatSymbol('(');
+    statement->value = parseExpression();
+    eatSymbol(')');
+    eatSymbol('{');
+    statement->body = parseStatements();
+    eatSymbol('}');
+    if(tokenKeyword() == KW_ELSE) {
+        eatKeyword(KW_ELSE);
+        eatSymbol('{');
+        statement->hasElse = true;
+        statement->elseBody = parseStatements();
+        eatSymbol('}');
+    }
+    return statement;
+}
+
+Statement *Parser::parseWhileStatement() {
+    Statement *statement = arena.make<Statement>();
+    statement->kind = STMT_WHILE;
+    statement->lineNumber = lineNumber();
+    eatKeyword(KW_WHILE);
+    eatSymbol('(');
+    statement->value = parseExpression();
+    eatSymbol(')');
+    eatSymbol('{');
+    statement->body = parseStatements();
+    eatSymbol('}');
+    return statement;
+}
+
+Statement *Parser::parseDoStatement() {
+    Statement *statement = arena.make<Statement>();
+    statement->kind = STMT_DO;
+    statement->lineNumber = lineNumber();
+    eatKeyword(KW_DO);
+    statement->call = parseSubroutineCall();
+    eatSymbol(';');
+    return statement;
+}
+
+Statement *Parser::parseReturnStatement() {
+    Statement *statement = arena.make<Statement>();
+    statement->kind = STMT_RETURN;
+    statement->lineNumber = lineNumber();
+    eatKeyword(KW_RETURN);
+    statement->value = parseExpression();
+    eatSymbol(';');
+    return statement;
+}
+
+// Returns null for an empty expression, which is accepted before ')' and ';'.
+Expression *Parser::parseExpression() {
+    if(tokenSymbol() == ')' || tokenSymbol() == ';') {
+        return nullptr;
+    }
+    Expression *expression = arena.make<Expression>();
+    expression->term = parseTerm();
+    OperatorTerm **rest = &expression->rest;
+    while(isOp()) {
+        *rest = arena.make<OperatorTerm>();
+        (*rest)->symbol = tokenSymbol();
+        eat(true, "binary operator");
+        (*rest)->term = parseTerm();
+        rest = &(*rest)->next;
+    }
+    return expression;
+}
+
+ExpressionList *Parser::parseExpressionList() {
+    Expression *expression = parseExpression();
+    if(!expression) {
+        return nullptr;
+    }
+    ExpressionList *first = arena.make<ExpressionList>();
+    first->expression = expression;
+    ExpressionList *last = first;
+    while(tokenSymbol() == ',') {
+        eatSymbol(',');
+        last->next = arena.make<ExpressionList>();
+        last = last->next;
+        last->expression = parseExpression();
+    }
+    return first;
+}
+
+Term *Parser::parseTerm() {
+    Term *term = arena.make<Term>();
+    term->lineNumber = lineNumber();
+    if(tokenType() == TT_INT) {
+        term->kind = TERM_INT;
+        long value = std::strtol(tokenName().c_str(), nullptr, 10);
+        if(value > 32767) {
+            throw SemanticError("Line " + std::to_string(lineNumber()) + ": " + "integer constant '" + tokenName() + "' is out of range");
+        }
+        term->value = (int)value;
+        term->text = eat(true, "integer");
+    } else if(tokenType() == TT_STRING) {
+        term->kind = TERM_STRING;
+        term->text = eat(true, "string");
+    } else if(tokenType() == TT_KEYWORD) {
+        int keyword = tokenKeyword();
+        if(keyword != KW_TRUE && keyword != KW_FALSE && keyword != KW_THIS && keyword != KW_NULL) {
+            throw SemanticError("'" + tokenName() + "' is not allowed here");
+        }
+        term->kind = TERM_KEYWORD;
+        term->keyword = keyword;
+        eat(true, "keyword");
+    } else if(tokenType() == TT_IDENTIFIER) {
+        char nextSymbol = tokenizer.nextToken().symbol;
+        if(nextSymbol == '[') {
+            term->kind = TERM_ARRAY;
+            term->name = eatIdentifier();
+            eatSymbol('[');
+            term->expression = parseExpression();
+            eatSymbol(']');
+        } else if(nextSymbol == '(' || nextSymbol == '.') {
+            term->kind = TERM_CALL;
+            term->call = parseSubroutineCall();
+        } else {
+            term->kind = TERM_VARIABLE;
+            term->name = eatIdentifier();
+        }
+    } else if(tokenSymbol() == '(') {
+        term->kind = TERM_PARENTHESES;
+        eatSymbol('(');
+        term->expression = parseExpression();
+        eatSymbol(')');
+    } else if(tokenSymbol() == '-' || tokenSymbol() == '~') {
+        term->kind = TERM_UNARY;
+        term->symbol = tokenSymbol();
+        eatSymbol(term->symbol);
+        term->operand = parseTerm();
+    } else {
+        eat(false, "term");
+    }
+    return term;
+}
+
+bool Parser::isOp() {
+    switch(tokenSymbol()) {
+        case '+': case '-': case '*': case '/': case '&': case '|': case '<': case '>': case '=':
+            return true;
+    }
+    return false;
+}
+
+SubroutineCall *Parser::parseSubroutineCall() {
+    SubroutineCall *call = arena.make<SubroutineCall>();
+    call->lineNumber = lineNumber();
+    int firstIdentifier = eatIdentifier();
+    if(tokenSymbol() == '.') {
+        eatSymbol('.');
+        call->className = firstIdentifier;
+        call->name = eatIdentifier();
+    } else {
+        call->name = firstIdentifier;
+    }
+    eatSymbol('(');
+    call->arguments = parseExpressionList();
+    eatSymbol(')');
+    return call;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include "arena.h"
+#include "ast.h"
+#include "compileerror.h"
+#include "stringtable.h"
+#include "tokenizer.h"
+
+// Recursive descent parser that builds the syntax tree of one class from
+// the tokens of a Tokenizer. Nodes are allocated in the given Arena.
+// Syntax errors are thrown as SyntaxError.
+class Parser {
+
+public:
+    Parser(Tokenizer &tokenizer, StringTable &stringTable, Arena &arena);
+    ClassDec *parseClass();
+
+private:
+    Tokenizer &tokenizer;
+    StringTable &strings;
+    Arena &arena;
+
+    std::string tokenName();
+    int tokenType();
+    int tokenKeyword();
+    char tokenSymbol();
+    int lineNumber();
+    int eat(bool valid, std::string whatExpected);
+    int eatIdentifier();
+    int eatType();
+    int eatKeyword(int keyword);
+    int eatSymbol(char symbol);
+    VarDec *parseClassVarDec();
+    SubroutineDec *parseSubroutineDec();
+    Parameter *parseParameter();
+    Parameter *parseParameterList();
+    VarDec *parseVarDec();
+    Name *parseNames();
+    Statement *parseStatements();
+    Statement *parseLetStatement();
+    Statement *parseIfStatement();
+    Statement *parseWhileStatement();
+    Statement *parseDoStatement();
+    Statement *parseReturnStatement();
+    Expression *parseExpression();
+    ExpressionList *parseExpressionList();
+    Term *parseTerm();
+    bool isOp();
+    SubroutineCall *parseSubroutineCall();
+
+};
\ No newline at end of file
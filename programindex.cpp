@@ -0,0 +1,87 @@
+#include <algorithm>
+#include "programindex.h"
+
+// A class that is defined in more than one file keeps the first
+// definition that was added.
+void ProgramIndex::addClass(const std::string &className, const std::vector<std::pair<std::string, SubroutineSignature>> &classSubroutines) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!classes.insert(className).second) {
+        return;
+    }
+    for(const auto &subroutine: classSubroutines) {
+        subroutines.insert({className + "." + subroutine.first, subroutine.second});
+    }
+}
+
+// Marks the subroutines that can be called from the entry points that the
+// program declares. If it declares none, such as a library, everything is
+// reachable.
+void ProgramIndex::findReachable(const std::vector<std::string> &entryPoints) {
+    std::vector<SubroutineSignature *> pending;
+    for(const std::string &entryPoint: entryPoints) {
+        auto entry = subroutines.find(entryPoint);
+        if(entry != subroutines.end()) {
+            pending.push_back(&entry->second);
+        }
+    }
+    for(auto &subroutine: subroutines) {
+        subroutine.second.reachable = pending.empty();
+    }
+    for(SubroutineSignature *entry: pending) {
+        entry->reachable = true;
+    }
+    while(!pending.empty()) {
+        SubroutineSignature *signature = pending.back();
+        pending.pop_back();
+        for(const std::string &callee: signature->callees) {
+            auto it = subroutines.find(callee);
+            if(it != subroutines.end() && !it->second.reachable) {
+                it->second.reachable = true;
+                pending.push_back(&it->second);
+            }
+        }
+    }
+}
+
+// Subroutines of classes outside the program count as reachable.
+bool ProgramIndex::isReachable(const std::string &fullName) const {
+    const SubroutineSignature *signature = find(fullName);
+    return !signature || signature->reachable;
+}
+
+bool ProgramIndex::hasClass(const std::string &className) const {
+    return classes.count(className) != 0;
+}
+
+const SubroutineSignature *ProgramIndex::find(const std::string &fullName) const {
+    auto it = subroutines.find(fullName);
+    return it != subroutines.end() ? &it->second : nullptr;
+}
+
+// Text that changes whenever any signature changes, independent of the
+// order in which classes were added.
+std::string ProgramIndex::digest() const {
+    std::vector<std::string> lines;
+    for(const std::string &className: classes) {
+        lines.push_back(className);
+    }
+    for(const auto &subroutine: subroutines) {
+        std::string line = subroutine.first + " " + std::to_string(subroutine.second.kind) + " " + std::to_string(subroutine.second.parameterCount);
+        for(const std::string &callee: subroutine.second.callees) {
+            line += " " + callee;
+        }
+        if(subroutine.second.inlinable) {
+            line += " inline";
+            for(const VMCommand &command: subroutine.second.inlineBody) {
+                line += " " + std::to_string(command.opcode) + ":" + std::to_string(command.segment) + ":" + std::to_string(command.arg);
+            }
+        }
+        lines.push_back(line);
+    }
+    std::sort(lines.begin(), lines.end());
+    std::string text;
+    for(const std::string &line: lines) {
+        text += line + "\n";
+    }
+    return text;
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "vmwriter.h"
+
+// kind is KW_CONSTRUCTOR, KW_FUNCTION or KW_METHOD. parameterCount does
+// not include the object of a method. callees are the full names of the
+// subroutines it calls, and reachable is set by findReachable(). A leaf
+// subroutine that can be inlined has its optimized code in inlineBody.
+struct SubroutineSignature {
+    int kind;
+    int parameterCount;
+    std::vector<std::string> callees;
+    bool reachable;
+    bool inlinable;
+    std::vector<VMCommand> inlineBody;
+};
+
+// Signatures of the subroutines of all classes of a program, by full name
+// such as "Main.main", and the call graph between them. Names are kept as
+// text because every Compiler has its own StringTable. addClass() may be
+// called from several threads while the index is built; findReachable()
+// and lookups are only done after that, when it no longer changes.
+class ProgramIndex {
+
+public:
+    void addClass(const std::string &className, const std::vector<std::pair<std::string, SubroutineSignature>> &subroutines);
+    void findReachable(const std::vector<std::string> &entryPoints);
+    bool hasClass(const std::string &className) const;
+    bool isReachable(const std::string &fullName) const;
+    const SubroutineSignature *find(const std::string &fullName) const;
+    std::string digest() const;
+
+private:
+    std::mutex mutex;
+    std::unordered_set<std::string> classes;
+    std::unordered_map<std::string, SubroutineSignature> subroutines;
+
+};
\ No newline at end of file
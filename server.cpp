@@ -0,0 +1,343 @@
+#include <cstdlib>
+#include <sstream>
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include "server.h"
+#include "driver.h"
+
+// Larger sources and outputs are refused rather than allocated.
+static const size_t maxMessageSize = 64 << 20;
+
+static bool parseLength(const std::string &text, size_t &length) {
+    if(text.empty() || text.size() > 10 || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    length = (size_t)std::atoll(text.c_str());
+    return length <= maxMessageSize;
+}
+
+#ifndef _WIN32
+
+static bool writeAll(int fd, const std::string &data) {
+    size_t written = 0;
+    while(written < data.size()) {
+        ssize_t count = write(fd, data.data() + written, data.size() - written);
+        if(count < 0 && errno == EINTR) {
+            continue;
+        }
+        if(count <= 0) {
+            return false;
+        }
+        written += count;
+    }
+    return true;
+}
+
+// Reads a line one byte at a time, so that none of the data after it is
+// consumed.
+static bool readLine(int fd, std::string &line) {
+    line.clear();
+    char c;
+    while(line.size() < 4096) {
+        ssize_t count = read(fd, &c, 1);
+        if(count < 0 && errno == EINTR) {
+            continue;
+        }
+        if(count <= 0) {
+            return false;
+        }
+        if(c == '\n') {
+            return true;
+        }
+        line += c;
+    }
+    return false;
+}
+
+static bool readBytes(int fd, size_t size, std::string &data) {
+    data.resize(size);
+    size_t done = 0;
+    while(done < size) {
+        ssize_t count = read(fd, &data[done], size - done);
+        if(count < 0 && errno == EINTR) {
+            continue;
+        }
+        if(count <= 0) {
+            return false;
+        }
+        done += count;
+    }
+    return true;
+}
+
+static bool socketAddress(const std::string &path, sockaddr_un &address, std::ostream &console) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(address.sun_path)) {
+        console << "Error: socket path is too long: " << path << std::endl;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+static int connectTo(const std::string &path, std::ostream &console) {
+    sockaddr_un address;
+    if(!socketAddress(path, address, console)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0 || connect(fd, (sockaddr *)&address, sizeof(address)) != 0) {
+        console << "Error: cannot connect to the compile server at " << path << std::endl;
+        if(fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+// Removes a socket left behind by a server that did not shut down, but
+// never a file of another kind.
+static void removeSocket(const std::string &path) {
+    struct stat status;
+    if(lstat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+        unlink(path.c_str());
+    }
+}
+
+#endif
+
+static std::string responseText(bool success, const std::string &diagnostics, const std::vector<std::pair<std::string, std::string>> &outputs) {
+    std::string response = success ? "status ok\n" : "status error\n";
+    response += "diagnostics " + std::to_string(diagnostics.size()) + "\n" + diagnostics;
+    for(const auto &output: outputs) {
+        response += "output " + output.first + " " + std::to_string(output.second.size()) + "\n" + output.second;
+    }
+    return response + "end\n";
+}
+
+CompileServer::CompileServer(CompilerOptions options): options(options), compiler(new Compiler(options)) {}
+
+// The result of the file moves to the front of recent, and results at the
+// back are dropped while the cache is over maxCachedBytes.
+const CompileServer::Result &CompileServer::compile(const std::string &filename, const std::string &source, bool &cached) {
+    auto found = results.find(filename);
+    if(found != results.end()) {
+        recent.splice(recent.begin(), recent, found->second);
+        cached = found->second->source == source;
+        if(cached) {
+            return recent.front();
+        }
+        cachedBytes -= found->second->bytes;
+    } else {
+        cached = false;
+        recent.push_front(Result());
+        recent.front().filename = filename;
+        results[filename] = recent.begin();
+    }
+    if(compiler->stringCount() >= maxStrings) {
+        compiler.reset(new Compiler(options));
+    }
+    Result &result = recent.front();
+    std::ostringstream diagnostics;
+    result.source = source;
+    result.success = compiler->compileSource(filename, source, diagnostics, result.outputs);
+    result.diagnostics = diagnostics.str();
+    result.bytes = result.filename.size() + result.source.size() + result.diagnostics.size();
+    for(const auto &output: result.outputs) {
+        result.bytes += output.first.size() + output.second.size();
+    }
+    cachedBytes += result.bytes;
+    while(cachedBytes > maxCachedBytes && recent.size() > 1) {
+        cachedBytes -= recent.back().bytes;
+        results.erase(recent.back().filename);
+        recent.pop_back();
+    }
+    return result;
+}
+
+// Answers the request on a connection. Returns false after a shutdown
+// request.
+bool CompileServer::handleConnection(int connection, std::ostream &log) {
+#ifdef _WIN32
+    return false;
+#else
+    std::string line;
+    if(!readLine(connection, line)) {
+        return true;
+    }
+    std::string filename;
+    std::string source;
+    std::string error;
+    bool fromFile = false;
+    size_t length;
+    if(line == "shutdown") {
+        writeAll(connection, responseText(true, "", {}));
+        log << "shutdown" << std::endl;
+        return false;
+    } else if(line.compare(0, 8, "compile ") == 0) {
+        filename = line.substr(8);
+        fromFile = true;
+        if(!readFile(filename, source)) {
+            error = "Error: cannot read " + filename + "\n";
+        }
+    } else if(line.compare(0, 7, "source ") == 0) {
+        size_t space = line.find(' ', 7);
+        if(space == std::string::npos || space + 1 == line.size() || !parseLength(line.substr(7, space - 7), length) || !readBytes(connection, length, source)) {
+            error = "Error: malformed source request\n";
+        } else {
+            filename = line.substr(space + 1);
+        }
+    } else {
+        error = "Error: unknown request\n";
+    }
+    if(!error.empty()) {
+        log << error;
+        writeAll(connection, responseText(false, error, {}));
+        return true;
+    }
+    bool cached;
+    const Result &result = compile(filename, source, cached);
+    log << (fromFile ? "compile " : "source ") << filename << (cached ? " (cached)" : "") << std::endl;
+    if(fromFile) {
+        std::string outputName = filename.substr(0, filename.rfind("."));
+        for(const auto &output: result.outputs) {
+            writeFile(outputName + output.first, output.second.data(), output.second.size());
+        }
+    }
+    writeAll(connection, responseText(result.success, result.diagnostics, result.outputs));
+    return true;
+#endif
+}
+
+// Serves requests until a shutdown request. A client that stalls while it
+// sends a request or reads the answer is dropped after a timeout, so it
+// cannot block the others.
+bool CompileServer::serve(const std::string &socketPath, std::ostream &log) {
+#ifdef _WIN32
+    log << "Error: the compile server needs Unix domain sockets" << std::endl;
+    return false;
+#else
+    signal(SIGPIPE, SIG_IGN);
+    sockaddr_un address;
+    if(!socketAddress(socketPath, address, log)) {
+        return false;
+    }
+    removeSocket(socketPath);
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listener < 0 || bind(listener, (sockaddr *)&address, sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        log << "Error: cannot listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        if(listener >= 0) {
+            close(listener);
+        }
+        return false;
+    }
+    log << "Compile server listening on " << socketPath << std::endl;
+    bool running = true;
+    while(running) {
+        int connection = accept(listener, nullptr, nullptr);
+        if(connection < 0) {
+            if(errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            log << "Error: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        timeval timeout = {10, 0};
+        setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        running = handleConnection(connection, log);
+        close(connection);
+    }
+    close(listener);
+    removeSocket(socketPath);
+    return !running;
+#endif
+}
+
+#ifndef _WIN32
+
+// Reads an answer; the contents of the outputs are skipped. Returns false
+// for a broken answer.
+static bool readResponse(int fd, bool &success, std::string &diagnostics) {
+    std::string line;
+    std::string data;
+    size_t length;
+    if(!readLine(fd, line) || line.compare(0, 7, "status ") != 0) {
+        return false;
+    }
+    success = line == "status ok";
+    if(!readLine(fd, line) || line.compare(0, 12, "diagnostics ") != 0 || !parseLength(line.substr(12), length) || !readBytes(fd, length, diagnostics)) {
+        return false;
+    }
+    while(readLine(fd, line)) {
+        if(line == "end") {
+            return true;
+        }
+        size_t space = line.rfind(' ');
+        if(line.compare(0, 7, "output ") != 0 || space == std::string::npos || !parseLength(line.substr(space + 1), length) || !readBytes(fd, length, data)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+static bool sendRequest(const std::string &socketPath, const std::string &request, bool &success, std::string &diagnostics, std::ostream &console) {
+    int fd = connectTo(socketPath, console);
+    if(fd < 0) {
+        return false;
+    }
+    bool answered = writeAll(fd, request) && readResponse(fd, success, diagnostics);
+    close(fd);
+    if(!answered) {
+        console << "Error: no answer from the compile server at " << socketPath << std::endl;
+    }
+    return answered;
+}
+
+#endif
+
+bool requestCompile(const std::string &socketPath, const std::vector<std::string> &filenames, std::ostream &console) {
+#ifdef _WIN32
+    console << "Error: the compile server needs Unix domain sockets" << std::endl;
+    return false;
+#else
+    signal(SIGPIPE, SIG_IGN);
+    bool allSucceeded = true;
+    for(const std::string &filename: filenames) {
+        // The server resolves paths in its own working directory.
+        char *absolute = realpath(filename.c_str(), nullptr);
+        std::string path = absolute ? absolute : filename;
+        std::free(absolute);
+        bool success;
+        std::string diagnostics;
+        if(!sendRequest(socketPath, "compile " + path + "\n", success, diagnostics, console)) {
+            return false;
+        }
+        console << diagnostics;
+        allSucceeded = allSucceeded && success;
+    }
+    return allSucceeded;
+#endif
+}
+
+bool requestShutdown(const std::string &socketPath, std::ostream &console) {
+#ifdef _WIN32
+    console << "Error: the compile server needs Unix domain sockets" << std::endl;
+    return false;
+#else
+    signal(SIGPIPE, SIG_IGN);
+    bool success;
+    std::string diagnostics;
+    return sendRequest(socketPath, "shutdown\n", success, diagnostics, console);
+#endif
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <iostream>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "compiler.h"
+
+// Compile server for editors and test harnesses: a warm process that
+// answers compile requests on a Unix domain socket, so that a request
+// costs only the compilation of its own class. One Compiler, with its
+// string table, serves all requests, and the result of the last
+// compilation of every file is kept with its source and answered again
+// while the source is unchanged. The cached results are bounded in size,
+// and the least recently requested files are dropped first. Requests are
+// handled one at a time, one per connection:
+//
+//   compile PATH               compile the file PATH and write its outputs
+//                              next to it, as the command line does
+//   source LENGTH PATH         followed by LENGTH bytes of source, compiled
+//                              as if it were the file PATH; nothing is
+//                              written
+//   shutdown                   stop the server
+//
+// Each request is a line. The answer is "status ok" or "status error", then
+// "diagnostics LENGTH" with the compiler messages, then "output SUFFIX
+// LENGTH" for every selected artifact, each header followed by LENGTH bytes,
+// and finally "end". Files are compiled on their own, without the
+// signatures of a whole program. The string table of the Compiler only
+// grows, so the Compiler is replaced by a new one once the table holds
+// maxStrings strings. Not available on Windows.
+class CompileServer {
+
+public:
+    CompileServer(CompilerOptions options);
+    bool serve(const std::string &socketPath, std::ostream &log);
+
+private:
+    struct Result {
+        std::string filename;
+        std::string source;
+        bool success;
+        std::string diagnostics;
+        std::vector<std::pair<std::string, std::string>> outputs;
+        size_t bytes;
+    };
+
+    static const size_t maxCachedBytes = 64 << 20;
+    static const int maxStrings = 1 << 20;
+    CompilerOptions options;
+    std::unique_ptr<Compiler> compiler;
+    // Most recently requested first.
+    std::list<Result> recent;
+    std::unordered_map<std::string, std::list<Result>::iterator> results;
+    size_t cachedBytes = 0;
+
+    bool handleConnection(int connection, std::ostream &log);
+    const Result &compile(const std::string &filename, const std::string &source, bool &cached);
+
+};
+
+// Client side of the protocol. requestCompile() sends a compile request
+// for each file and prints the diagnostics; it returns false when a file
+// has errors or the server cannot be reached.
+bool requestCompile(const std::string &socketPath, const std::vector<std::string> &filenames, std::ostream &console);
+bool requestShutdown(const std::string &socketPath, std::ostream &console);
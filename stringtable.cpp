@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cstring>
+#include "stringtable.h"
+
+static const char *predefinedStrings[] = {"", "class", "constructor", "function", "method", "field",
+                                          "static", "var", "int", "char", "boolean", "void", "true",
+                                          "false", "null", "this", "let", "do", "if", "else", "while", "return"};
+
+StringTable::StringTable() {
+    slots.assign(256, -1);
+    for(const char *str: predefinedStrings) {
+        intern(str, (int)std::strlen(str));
+    }
+}
+
+unsigned StringTable::hashOf(const char *str, int length) {
+    unsigned hash = 2166136261u;
+    for(int i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)str[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Returns the slot holding the string, or the empty slot where it belongs.
+int StringTable::lookup(const char *str, int length, unsigned hash) {
+    int mask = (int)slots.size() - 1;
+    int slot = (int)(hash & mask);
+    while(slots[slot] != -1) {
+        const Entry &entry = entries[slots[slot]];
+        if(entry.hash == hash && entry.length == length && std::memcmp(entry.text, str, length) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+const char *StringTable::store(const char *str, int length) {
+    if(blocks.empty() || length > blockSize - blockUsed) {
+        blocks.push_back(std::unique_ptr<char[]>(new char[std::max(length, (int)blockSize)]));
+        blockUsed = 0;
+    }
+    char *destination = blocks.back().get() + blockUsed;
+    std::memcpy(destination, str, length);
+    blockUsed += length;
+    return destination;
+}
+
+void StringTable::grow() {
+    slots.assign(slots.size() * 2, -1);
+    int mask = (int)slots.size() - 1;
+    for(int id = 0; id < (int)entries.size(); id++) {
+        int slot = (int)(entries[id].hash & mask);
+        while(slots[slot] != -1) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = id;
+    }
+}
+
+int StringTable::intern(const char *str, int length) {
+    unsigned hash = hashOf(str, length);
+    int slot = lookup(str, length, hash);
+    if(slots[slot] != -1) {
+        return slots[slot];
+    }
+    int id = (int)entries.size();
+    entries.push_back({store(str, length), length, hash});
+    slots[slot] = id;
+    if(entries.size() * 2 > slots.size()) {
+        grow();
+    }
+    return id;
+}
+
+int StringTable::intern(const std::string &str) {
+    return intern(str.data(), (int)str.size());
+}
+
+// Returns the id of an already interned string, or -1.
+int StringTable::find(const std::string &str) {
+    int slot = lookup(str.data(), (int)str.size(), hashOf(str.data(), (int)str.size()));
+    return slots[slot];
+}
+
+const char *StringTable::text(int id) {
+    return entries[id].text;
+}
+
+int StringTable::length(int id) {
+    return entries[id].length;
+}
+
+std::string StringTable::str(int id) {
+    return std::string(entries[id].text, entries[id].length);
+}
+
+int StringTable::size() {
+    return (int)entries.size();
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Interns strings so that every distinct string is stored once and can be
+// compared by a small integer id. Characters live in fixed-size arena blocks
+// that never move, so text(id) stays valid for the lifetime of the table.
+// The first ids are reserved for the keywords, in the order of the Keyword
+// enum, so the id of a keyword token equals its Keyword value.
+// A table is not synchronized; each Compiler (and so each worker thread)
+// owns its own.
+class StringTable {
+
+public:
+    StringTable();
+    int intern(const char *str, int length);
+    int intern(const std::string &str);
+    int find(const std::string &str);
+    const char *text(int id);
+    int length(int id);
+    std::string str(int id);
+    int size();
+
+private:
+    struct Entry {
+        const char *text;
+        int length;
+        unsigned hash;
+    };
+
+    static const int blockSize = 1 << 16;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    int blockUsed = blockSize;
+    std::vector<Entry> entries;
+    std::vector<int> slots;
+
+    static unsigned hashOf(const char *str, int length);
+    int lookup(const char *str, int length, unsigned hash);
+    const char *store(const char *str, int length);
+    void grow();
+
+};
\ No newline at end of file
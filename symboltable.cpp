@@ -0,0 +1,56 @@
+#include <algorithm>
+#include "symboltable.h"
+
+void SymbolTable::pushScope() {
+    scopes.push_back(Scope());
+}
+
+void SymbolTable::popScope() {
+    scopes.pop_back();
+}
+
+// Adds a variable to the innermost scope. Returns false if the name is
+// already defined in that scope.
+bool SymbolTable::define(int name, int type, SymbolKind kind) {
+    Scope &scope = scopes.back();
+    int index = varCount(kind);
+    if(!scope.symbols.insert({name, {name, type, kind, index}}).second) {
+        return false;
+    }
+    scope.counts[kind]++;
+    return true;
+}
+
+// Returns the entry for the name, or nullptr if it is not defined. depth is
+// set to the number of scopes searched before the name was found.
+const SymbolTableEntry *SymbolTable::find(int name, int *depth) {
+    lookupStats.lookups++;
+    for(int i = (int)scopes.size() - 1; i >= 0; i--) {
+        auto it = scopes[i].symbols.find(name);
+        if(it != scopes[i].symbols.end()) {
+            int found = (int)scopes.size() - 1 - i;
+            lookupStats.hitsByDepth[std::min(found, SymbolTableStats::depthCount - 1)]++;
+            if(depth) {
+                *depth = found;
+            }
+            return &it->second;
+        }
+    }
+    lookupStats.misses++;
+    if(depth) {
+        *depth = (int)scopes.size();
+    }
+    return nullptr;
+}
+
+int SymbolTable::varCount(SymbolKind kind) {
+    int count = 0;
+    for(const Scope &scope: scopes) {
+        count += scope.counts[kind];
+    }
+    return count;
+}
+
+const SymbolTableStats &SymbolTable::stats() {
+    return lookupStats;
+}
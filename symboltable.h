@@ -0,0 +1,53 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+enum SymbolKind {
+    SK_STATIC,
+    SK_FIELD,
+    SK_ARGUMENT,
+    SK_LOCAL,
+    SK_COUNT
+};
+
+// name and type are ids in the compiler's StringTable
+struct SymbolTableEntry {
+    int name;
+    int type;
+    SymbolKind kind;
+    int index;
+};
+
+// Lookups made with find(). hitsByDepth counts the names found after
+// searching 0, 1, ... enclosing scopes; deeper hits go to the last bucket.
+struct SymbolTableStats {
+    static const int depthCount = 4;
+    long long lookups = 0;
+    long long hitsByDepth[depthCount] = {};
+    long long misses = 0;
+};
+
+// Stack of scopes, each a hash map from name id to entry. Lookups search
+// from the innermost scope outwards. Indices are assigned per kind in the
+// order variables are defined.
+class SymbolTable {
+
+public:
+    void pushScope();
+    void popScope();
+    bool define(int name, int type, SymbolKind kind);
+    const SymbolTableEntry *find(int name, int *depth = nullptr);
+    int varCount(SymbolKind kind);
+    const SymbolTableStats &stats();
+
+private:
+    struct Scope {
+        std::unordered_map<int, SymbolTableEntry> symbols;
+        int counts[SK_COUNT] = {};
+    };
+
+    std::vector<Scope> scopes;
+    SymbolTableStats lookupStats;
+
+};
@@ -0,0 +1,33 @@
+# Compiles and runs one test program and compares what it prints with
+# expected.txt in its directory. A program with expected_error.txt must
+# fail instead, with that text in its error messages. The sources are
+# copied to WORK first, because the compiler writes its output next to
+# them.
+#
+#   cmake -DCOMPILER=JackCompiler -DSOURCE=dir -DWORK=dir -DFLAGS="-O1 ..." -P runprogram.cmake
+
+separate_arguments(flags UNIX_COMMAND "${FLAGS}")
+file(REMOVE_RECURSE "${WORK}")
+file(MAKE_DIRECTORY "${WORK}")
+file(GLOB sources "${SOURCE}/*.jack")
+file(COPY ${sources} DESTINATION "${WORK}")
+execute_process(
+    COMMAND "${COMPILER}" run ${flags} "${WORK}/"
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE errors
+    RESULT_VARIABLE result
+)
+if(EXISTS "${SOURCE}/expected_error.txt")
+    file(READ "${SOURCE}/expected_error.txt" expected_error)
+    string(STRIP "${expected_error}" expected_error)
+    string(FIND "${errors}" "${expected_error}" found)
+    if(result EQUAL 0 OR found EQUAL -1)
+        message(FATAL_ERROR "JackCompiler run ${FLAGS} should fail with:\n${expected_error}\nbut returned ${result}:\n${errors}")
+    endif()
+elseif(NOT result EQUAL 0)
+    message(FATAL_ERROR "JackCompiler run ${FLAGS} failed (${result}):\n${errors}")
+endif()
+file(READ "${SOURCE}/expected.txt" expected)
+if(NOT output STREQUAL expected)
+    message(FATAL_ERROR "JackCompiler run ${FLAGS} printed:\n${output}\nexpected:\n${expected}")
+endif()
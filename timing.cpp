@@ -0,0 +1,163 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include "timing.h"
+
+const char *const phaseNames[] = {"tokenize", "parse", "xml", "vm", "optimize", "write"};
+
+double wallSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double threadCPUSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if(!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+        return 0;
+    }
+    unsigned long long kernelTicks = ((unsigned long long)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+    unsigned long long userTicks = ((unsigned long long)user.dwHighDateTime << 32) | user.dwLowDateTime;
+    return (kernelTicks + userTicks) * 1e-7;
+#else
+    timespec time;
+    if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+        return 0;
+    }
+    return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+}
+
+void PhaseTimer::clear() {
+    spanList.clear();
+    open = false;
+}
+
+void PhaseTimer::begin(Phase phase) {
+    end();
+    spanList.push_back({phase, wallSeconds(), 0, 0});
+    startCPU = threadCPUSeconds();
+    open = true;
+}
+
+void PhaseTimer::end() {
+    if(open) {
+        PhaseSpan &span = spanList.back();
+        span.wall = wallSeconds() - span.start;
+        span.cpu = threadCPUSeconds() - startCPU;
+        open = false;
+    }
+}
+
+const std::vector<PhaseSpan> &PhaseTimer::spans() const {
+    return spanList;
+}
+
+// Writes wall/CPU milliseconds per phase for every file, then the sums
+// over all files. The sums add up the time of all worker threads, so they
+// can exceed the wall time of the build.
+void writeTimeReport(std::ostream &report, const std::vector<FileTiming> &files, double declareWall, double buildWall) {
+    char cell[64];
+    std::string header = "file                      ";
+    for(int phase = 0; phase < PHASE_COUNT; phase++) {
+        std::snprintf(cell, sizeof(cell), "%16s", phaseNames[phase]);
+        header += cell;
+    }
+    report << "Time report (wall/cpu ms)" << std::endl;
+    report << header << "           total" << std::endl;
+    double totalWall[PHASE_COUNT] = {};
+    double totalCPU[PHASE_COUNT] = {};
+    double sumWall = 0;
+    double sumCPU = 0;
+    auto row = [&](const std::string &name, const double *wall, const double *cpu, double fileWall, double fileCPU, bool cached) {
+        std::snprintf(cell, sizeof(cell), "%-26s", name.c_str());
+        std::string line = cell;
+        for(int phase = 0; phase < PHASE_COUNT; phase++) {
+            if(cached) {
+                std::snprintf(cell, sizeof(cell), "%16s", phase == 0 ? "(cached)" : "-");
+            } else {
+                std::snprintf(cell, sizeof(cell), "%8.2f/%-7.2f", wall[phase] * 1e3, cpu[phase] * 1e3);
+            }
+            line += cell;
+        }
+        std::snprintf(cell, sizeof(cell), "%8.2f/%.2f", fileWall * 1e3, fileCPU * 1e3);
+        report << line << cell << std::endl;
+    };
+    for(const FileTiming &file: files) {
+        double wall[PHASE_COUNT] = {};
+        double cpu[PHASE_COUNT] = {};
+        for(const PhaseSpan &span: file.spans) {
+            wall[span.phase] += span.wall;
+            cpu[span.phase] += span.cpu;
+            totalWall[span.phase] += span.wall;
+            totalCPU[span.phase] += span.cpu;
+        }
+        sumWall += file.wall;
+        sumCPU += file.cpu;
+        row(file.name.substr(file.name.find_last_of("/\\") + 1), wall, cpu, file.wall, file.cpu, file.cached);
+    }
+    row("all files", totalWall, totalCPU, sumWall, sumCPU, false);
+    if(declareWall > 0) {
+        std::snprintf(cell, sizeof(cell), "%.2f", declareWall * 1e3);
+        report << "Declare pass: " << cell << " ms" << std::endl;
+    }
+    std::snprintf(cell, sizeof(cell), "%.2f", buildWall * 1e3);
+    report << "Build: " << cell << " ms wall" << std::endl;
+}
+
+// Quotes text as a JSON string.
+std::string jsonString(const std::string &text) {
+    std::string result = "\"";
+    for(char c: text) {
+        if(c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if((unsigned char)c < 0x20) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+            result += escape;
+        } else {
+            result += c;
+        }
+    }
+    return result + "\"";
+}
+
+BuildTrace::BuildTrace(): origin(wallSeconds()) {}
+
+void BuildTrace::addSpan(const std::string &name, const char *category, double start, double duration, const std::string &file) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto thread = threads.insert({std::this_thread::get_id(), (int)threads.size()}).first;
+    events.push_back({name, category, thread->second, start, duration, file});
+}
+
+// Complete ("X") events in microseconds since the trace was created, and
+// a thread_name metadata event per worker.
+bool BuildTrace::write(const std::string &filename) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ofstream stream(filename, std::ios::out | std::ios::trunc);
+    if(!stream.is_open()) {
+        return false;
+    }
+    std::ostringstream json;
+    json << "{\"traceEvents\":[\n";
+    for(size_t i = 0; i < threads.size(); i++) {
+        json << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":\"worker " << i << "\"}},\n";
+    }
+    char times[64];
+    for(size_t i = 0; i < events.size(); i++) {
+        const Event &event = events[i];
+        std::snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f", (event.start - origin) * 1e6, event.duration * 1e6);
+        json << "{\"name\":" << jsonString(event.name) << ",\"cat\":\"" << event.category << "\",\"ph\":\"X\","
+             << times << ",\"pid\":1,\"tid\":" << event.thread << ",\"args\":{\"file\":" << jsonString(event.file) << "}}"
+             << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    json << "],\"displayTimeUnit\":\"ms\"}\n";
+    stream << json.str();
+    return (bool)stream;
+}
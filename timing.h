@@ -0,0 +1,88 @@
+#pragma once
+
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+enum Phase {
+    PHASE_TOKENIZE,
+    PHASE_PARSE,
+    PHASE_XML,
+    PHASE_VM,
+    PHASE_OPTIMIZE,
+    PHASE_WRITE,
+    PHASE_COUNT
+};
+
+extern const char *const phaseNames[];
+
+// Seconds on a monotonic clock, and CPU seconds used by the calling thread.
+double wallSeconds();
+double threadCPUSeconds();
+
+// start is a wallSeconds() time.
+struct PhaseSpan {
+    Phase phase;
+    double start;
+    double wall;
+    double cpu;
+};
+
+// Records the phases of one compilation. begin() ends the phase that is
+// still open, so consecutive phases need no end() in between.
+class PhaseTimer {
+
+public:
+    void clear();
+    void begin(Phase phase);
+    void end();
+    const std::vector<PhaseSpan> &spans() const;
+
+private:
+    std::vector<PhaseSpan> spanList;
+    bool open = false;
+    double startCPU = 0;
+
+};
+
+// Timing of one file of a build. Restored files have no phases.
+struct FileTiming {
+    std::string name;
+    bool cached = false;
+    double wall = 0;
+    double cpu = 0;
+    std::vector<PhaseSpan> spans;
+};
+
+void writeTimeReport(std::ostream &report, const std::vector<FileTiming> &files, double declareWall, double buildWall);
+std::string jsonString(const std::string &text);
+
+// Collects spans from the worker threads of a build and writes them in the
+// Chrome trace event format, which chrome://tracing and Perfetto load.
+// Every thread gets a small id in the order it first adds a span.
+class BuildTrace {
+
+public:
+    BuildTrace();
+    void addSpan(const std::string &name, const char *category, double start, double duration, const std::string &file);
+    bool write(const std::string &filename);
+
+private:
+    struct Event {
+        std::string name;
+        const char *category;
+        int thread;
+        double start;
+        double duration;
+        std::string file;
+    };
+
+    double origin;
+    std::mutex mutex;
+    std::vector<Event> events;
+    std::unordered_map<std::thread::id, int> threads;
+
+};
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstring>
 #include "tokenizer.h"
 #include "debug.h"
 
@@ -15,14 +17,61 @@ enum State {
 
 const std::string charTokens = "{}()[].,;+-*/&|<>=-~";
 const std::string nalnumChars = "-_.";
-const std::vector<std::string> keywords = {"class", "constructor", "function", "method", "field",
-                                           "static", "var", "int", "char", "boolean", "void", "true",
-                                           "false", "null", "this", "let", "do", "if", "else", "while", "return"};
+static Keyword matchKeyword(const char *str, int length, const char *keyword, Keyword result) {
+    return std::memcmp(str, keyword, length) == 0 ? result : KW_NONE;
+}
 
-void Tokenizer::addCharToken(char c) {
-    std::string str;
-    str += c;
-    tokens.push_back({str, TT_SYMBOL, currentLineNumber});
+// Identifiers are classified by a switch on length and first character,
+// which leaves at most one candidate keyword to compare against.
+static Keyword classifyKeyword(const char *str, int length) {
+    switch(length) {
+        case 2:
+            switch(str[0]) {
+                case 'd': return matchKeyword(str, length, "do",          KW_DO);
+                case 'i': return matchKeyword(str, length, "if",          KW_IF);
+            }
+            break;
+        case 3:
+            switch(str[0]) {
+                case 'i': return matchKeyword(str, length, "int",         KW_INT);
+                case 'l': return matchKeyword(str, length, "let",         KW_LET);
+                case 'v': return matchKeyword(str, length, "var",         KW_VAR);
+            }
+            break;
+        case 4:
+            switch(str[0]) {
+                case 'c': return matchKeyword(str, length, "char",        KW_CHAR);
+                case 'e': return matchKeyword(str, length, "else",        KW_ELSE);
+                case 'n': return matchKeyword(str, length, "null",        KW_NULL);
+                case 't': return str[1] == 'h' ? matchKeyword(str, length, "this", KW_THIS)
+                                               : matchKeyword(str, length, "true", KW_TRUE);
+                case 'v': return matchKeyword(str, length, "void",        KW_VOID);
+            }
+            break;
+        case 5:
+            switch(str[0]) {
+                case 'c': return matchKeyword(str, length, "class",       KW_CLASS);
+                case 'f': return str[1] == 'i' ? matchKeyword(str, length, "field", KW_FIELD)
+                                               : matchKeyword(str, length, "false", KW_FALSE);
+                case 'w': return matchKeyword(str, length, "while",       KW_WHILE);
+            }
+            break;
+        case 6:
+            switch(str[0]) {
+                case 'm': return matchKeyword(str, length, "method",      KW_METHOD);
+                case 'r': return matchKeyword(str, length, "return",      KW_RETURN);
+                case 's': return matchKeyword(str, length, "static",      KW_STATIC);
+            }
+            break;
+        case 7:  return matchKeyword(str, length, "boolean",     KW_BOOLEAN);
+        case 8:  return matchKeyword(str, length, "function",    KW_FUNCTION);
+        case 11: return matchKeyword(str, length, "constructor", KW_CONSTRUCTOR);
+    }
+    return KW_NONE;
+}
+
+void Tokenizer::addCharToken(int offset) {
+    tokens.push_back({offset, 1, strings->intern(source.data() + offset, 1), currentLineNumber, TT_SYMBOL, KW_NONE, source[offset]});
 }
 
 std::string Tokenizer::typeToStr(int type) {
@@ -37,15 +86,13 @@ std::string Tokenizer::typeToStr(int type) {
     return typeStr;
 }
 
-void Tokenizer::addStringToken(std::string token, TokenSubType subType) {
-    TokenType type;
+void Tokenizer::addStringToken(int start, int end, TokenSubType subType) {
+    TokenType type = TT_IDENTIFIER;
+    Keyword keyword = KW_NONE;
     if(subType == ST_ALNUM) {
-        type = TT_IDENTIFIER;
-        for(std::string str: keywords) {
-            if(str == token) {
-                type = TT_KEYWORD;
-                break;
-            }
+        keyword = classifyKeyword(source.data() + start, end - start);
+        if(keyword != KW_NONE) {
+            type = TT_KEYWORD;
         }
     }
     if(subType == ST_INT) {
@@ -54,52 +101,96 @@ void Tokenizer::addStringToken(std::string token, TokenSubType subType) {
     if(subType == ST_STRING) {
         type = TT_STRING;
     }
-    tokens.push_back({token, type, currentLineNumber});
+    int id = keyword != KW_NONE ? (int)keyword : strings->intern(source.data() + start, end - start);
+    tokens.push_back({start, end - start, id, currentLineNumber, (unsigned char)type, (unsigned char)keyword, 0});
+}
+
+// Adds the token that is still being read when a delimiter is reached.
+void Tokenizer::finishToken(int state, int tokenStart, int offset) {
+    if(state == S_ALNUM_TOKEN) {
+        addStringToken(tokenStart, offset, ST_ALNUM);
+    } else if(state == S_INT_TOKEN) {
+        addStringToken(tokenStart, offset, ST_INT);
+    } else if(state == S_SLASH) {
+        addCharToken(offset - 1);
+    }
+}
+
+bool Tokenizer::readFile(std::string inputFilename) {
+    std::ifstream inputStream(inputFilename, std::ios::in | std::ios::binary);
+    if(!inputStream.is_open()) {
+        return false;
+    }
+    inputStream.seekg(0, std::ios::end);
+    std::streamoff size = inputStream.tellg();
+    inputStream.seekg(0, std::ios::beg);
+    source.resize((size_t)std::max<std::streamoff>(size, 0));
+    if(!source.empty()) {
+        inputStream.read(&source[0], source.size());
+        source.resize((size_t)inputStream.gcount());
+    }
+    return true;
 }
 
-void Tokenizer::tokenize(std::string inputFilename) {
-    std::fstream inputStream(inputFilename);
-    if(inputStream.bad()) {
-        std::cout << "Error" << std::endl;
+// Raises a CompileError if the file cannot be read.
+void Tokenizer::tokenize(std::string inputFilename, StringTable &stringTable) {
+    if(!readFile(inputFilename)) {
+        throw CompileError("cannot read file '" + inputFilename + "'");
     }
-    char c;
-    std::string alphanumTokenBuffer;
-    std::string intTokenBuffer;
-    std::string stringConstantBuffer;
+    scan(stringTable);
+}
+
+// Tokenizes source text that is already in memory, such as the unsaved
+// buffer of an editor.
+void Tokenizer::tokenizeText(const std::string &text, StringTable &stringTable) {
+    source = text;
+    scan(stringTable);
+}
+
+void Tokenizer::scan(StringTable &stringTable) {
+    strings = &stringTable;
+    int sourceSize = (int)source.size();
+    int tokenStart = 0;
     State currentState = S_SPACE;
-    while(inputStream >> std::noskipws >> c) {
-        debugPrintLine("", DL_SYMBOLS);
-        debugPrint("State: ", DL_SYMBOLS);
-        switch(currentState) {
-            case S_SPACE:             debugPrintLine("space",             DL_SYMBOLS);  break;
-            case S_SLASH:             debugPrintLine("slash",             DL_SYMBOLS);  break;
-            case S_STAR:              debugPrintLine("star",              DL_SYMBOLS);  break;
-            case S_COMMENT:           debugPrintLine("comment",           DL_SYMBOLS);  break;
-            case S_MULTILINE_COMMENT: debugPrintLine("multiline_comment", DL_SYMBOLS);  break;
-            case S_ALNUM_TOKEN:       debugPrintLine("alnum_token",       DL_SYMBOLS);  break;
-            case S_CHAR_TOKEN:        debugPrintLine("char_token",        DL_SYMBOLS);  break;
-            case S_INT_TOKEN:         debugPrintLine("int_token",         DL_SYMBOLS);  break;
-            case S_STRING:            debugPrintLine("string",            DL_SYMBOLS);  break;
-        }
-        if(c == '\n') {
-            debugPrintLine("Read symbol \\n", DL_SYMBOLS);
-        } else {
-            debugPrintLine(std::string("Read symbol ") + c, DL_SYMBOLS);
+    for(int i = 0; i < sourceSize; i++) {
+        char c = source[i];
+        if(debugLayerEnabled(DL_SYMBOLS)) {
+            DEBUG_PRINT_LINE("", DL_SYMBOLS);
+            DEBUG_PRINT("State: ", DL_SYMBOLS);
+            switch(currentState) {
+                case S_SPACE:             DEBUG_PRINT_LINE("space",             DL_SYMBOLS);  break;
+                case S_SLASH:             DEBUG_PRINT_LINE("slash",             DL_SYMBOLS);  break;
+                case S_STAR:              DEBUG_PRINT_LINE("star",              DL_SYMBOLS);  break;
+                case S_COMMENT:           DEBUG_PRINT_LINE("comment",           DL_SYMBOLS);  break;
+                case S_MULTILINE_COMMENT: DEBUG_PRINT_LINE("multiline_comment", DL_SYMBOLS);  break;
+                case S_ALNUM_TOKEN:       DEBUG_PRINT_LINE("alnum_token",       DL_SYMBOLS);  break;
+                case S_CHAR_TOKEN:        DEBUG_PRINT_LINE("char_token",        DL_SYMBOLS);  break;
+                case S_INT_TOKEN:         DEBUG_PRINT_LINE("int_token",         DL_SYMBOLS);  break;
+                case S_STRING:            DEBUG_PRINT_LINE("string",            DL_SYMBOLS);  break;
+            }
+            if(c == '\n') {
+                DEBUG_PRINT_LINE("Read symbol \\n", DL_SYMBOLS);
+            } else {
+                DEBUG_PRINT_LINE(std::string("Read symbol ") + c, DL_SYMBOLS);
+            }
         }
         if(c == '\n') {
-            currentLineNumber++;
             if(currentState != S_MULTILINE_COMMENT && currentState != S_STAR) {
+                finishToken(currentState, tokenStart, i);
+                currentLineNumber++;
                 currentState = S_SPACE;
                 continue;
-            } else if(currentState == S_STAR) {
+            }
+            currentLineNumber++;
+            if(currentState == S_STAR) {
                 currentState = S_MULTILINE_COMMENT;
                 continue;
             }
         }
         if(c == '/') {
-            debugPrintLine("Slash symbol found", DL_SYMBOLS);
+            DEBUG_PRINT_LINE("Slash symbol found", DL_SYMBOLS);
             if(currentState == S_SLASH) {
-                debugPrintLine("Comment found", DL_SYMBOLS);
+                DEBUG_PRINT_LINE("Comment found", DL_SYMBOLS);
                 currentState = S_COMMENT;
                 continue;
             } else if(currentState == S_SPACE || currentState == S_CHAR_TOKEN) {
@@ -126,132 +217,118 @@ void Tokenizer::tokenize(std::string inputFilename) {
             }
         }
         if(c == '"') {
-            if(currentState == S_SPACE || currentState == S_CHAR_TOKEN) {
+            if(currentState == S_SPACE || currentState == S_CHAR_TOKEN || currentState == S_SLASH) {
+                finishToken(currentState, tokenStart, i);
                 currentState = S_STRING;
-                stringConstantBuffer.clear();
+                tokenStart = i + 1;
                 continue;
             } else if(currentState == S_STRING) {
                 currentState = S_SPACE;
-                addStringToken(stringConstantBuffer, ST_STRING);
+                addStringToken(tokenStart, i, ST_STRING);
                 continue;
             }
         }
         if(c != '\n' && c != '"') {
             if(currentState == S_STRING) {
-                stringConstantBuffer += c;
                 continue;
             }
         }
         if(std::isspace(c)) {
-            debugPrintLine("Whitespace symbol found", DL_SYMBOLS);
-            if(currentState == S_ALNUM_TOKEN) {
+            DEBUG_PRINT_LINE("Whitespace symbol found", DL_SYMBOLS);
+            if(currentState == S_ALNUM_TOKEN || currentState == S_INT_TOKEN || currentState == S_SLASH) {
+                finishToken(currentState, tokenStart, i);
                 currentState = S_SPACE;
-                addStringToken(alphanumTokenBuffer, ST_ALNUM);
                 continue;
             } else if(currentState == S_CHAR_TOKEN) {
                 currentState = S_SPACE;
                 continue;
-            } else if(currentState == S_INT_TOKEN) {
-                currentState = S_SPACE;
-                addStringToken(intTokenBuffer, ST_INT);
-                continue;
-            } else if(currentState == S_SLASH) {
-                currentState = S_SPACE;
-                addCharToken('/');
-                continue;
             }
         }
         if(std::isalpha(c) || c == '_') {
-            debugPrintLine("Letter symbol found", DL_SYMBOLS);
-            if(currentState == S_SLASH) {
-                addCharToken('/');
+            DEBUG_PRINT_LINE("Letter symbol found", DL_SYMBOLS);
+            if(currentState == S_SPACE || currentState == S_CHAR_TOKEN || currentState == S_SLASH) {
+                finishToken(currentState, tokenStart, i);
                 currentState = S_ALNUM_TOKEN;
-                alphanumTokenBuffer.clear();
-                alphanumTokenBuffer += c;
-                continue;
-            } else if(currentState == S_SPACE || currentState == S_CHAR_TOKEN) {
-                currentState = S_ALNUM_TOKEN;
-                alphanumTokenBuffer.clear();
-                alphanumTokenBuffer += c;
-                debugPrintLine("alphanumTokenBuffer: " + alphanumTokenBuffer, DL_SYMBOLS);
+                tokenStart = i;
                 continue;
             } else if(currentState == S_ALNUM_TOKEN) {
-                alphanumTokenBuffer += c;
-                debugPrintLine("alphanumTokenBuffer: " + alphanumTokenBuffer, DL_SYMBOLS);
+                DEBUG_PRINT_LINE("alphanumTokenBuffer: " + source.substr(tokenStart, i + 1 - tokenStart), DL_SYMBOLS);
                 continue;
             }
         }
         if(std::isdigit(c)) {
-            debugPrintLine("Digit found", DL_SYMBOLS);
-            if(currentState == S_SLASH) {
-                addCharToken('/');
+            DEBUG_PRINT_LINE("Digit found", DL_SYMBOLS);
+            if(currentState == S_SPACE || currentState == S_CHAR_TOKEN || currentState == S_SLASH) {
+                finishToken(currentState, tokenStart, i);
                 currentState = S_INT_TOKEN;
-                alphanumTokenBuffer.clear();
-                alphanumTokenBuffer += c;
-                continue;
-            } else if(currentState == S_SPACE || currentState == S_CHAR_TOKEN) {
-                currentState = S_INT_TOKEN;
-                intTokenBuffer.clear();
-                intTokenBuffer += c;
-                debugPrintLine("intTokenBuffer: " + intTokenBuffer, DL_SYMBOLS);
-                continue;
-            } else if(currentState == S_ALNUM_TOKEN) {
-                alphanumTokenBuffer += c;
-                debugPrintLine("alphanumTokenBuffer: " + alphanumTokenBuffer, DL_SYMBOLS);
+                tokenStart = i;
                 continue;
-            } else if(currentState == S_INT_TOKEN) {
-                intTokenBuffer += c;
-                debugPrintLine("intTokenBuffer: " + intTokenBuffer, DL_SYMBOLS);
+            } else if(currentState == S_ALNUM_TOKEN || currentState == S_INT_TOKEN) {
+                DEBUG_PRINT_LINE("tokenBuffer: " + source.substr(tokenStart, i + 1 - tokenStart), DL_SYMBOLS);
                 continue;
             }
         }
         if(charTokens.find(c) != std::string::npos) {
-            debugPrintLine("Char token found", DL_SYMBOLS);
-            if(currentState == S_SPACE || currentState == S_CHAR_TOKEN) {
+            DEBUG_PRINT_LINE("Char token found", DL_SYMBOLS);
+            if(currentState == S_SPACE || currentState == S_CHAR_TOKEN || currentState == S_ALNUM_TOKEN ||
+               currentState == S_INT_TOKEN || currentState == S_SLASH) {
+                finishToken(currentState, tokenStart, i);
                 currentState = S_CHAR_TOKEN;
-                addCharToken(c);
-                continue;
-            } else if(currentState == S_ALNUM_TOKEN) {
-                currentState = S_CHAR_TOKEN;
-                addStringToken(alphanumTokenBuffer, ST_ALNUM);
-                addCharToken(c);
-                continue;
-            } else if(currentState == S_INT_TOKEN) {
-                currentState = S_CHAR_TOKEN;
-                addStringToken(intTokenBuffer, ST_INT);
-                addCharToken(c);
+                addCharToken(i);
                 continue;
             }
-         }
+        }
         if(nalnumChars.find(c) != std::string::npos) {
             if(currentState == S_ALNUM_TOKEN) {
-                alphanumTokenBuffer += c;
-                debugPrintLine("alphanumTokenBuffer: " + alphanumTokenBuffer, DL_SYMBOLS);
+                DEBUG_PRINT_LINE("alphanumTokenBuffer: " + source.substr(tokenStart, i + 1 - tokenStart), DL_SYMBOLS);
                 continue;
             }
         }
     }
-    debugPrintLine("", DL_SYMBOLS);
+    finishToken(currentState, tokenStart, sourceSize);
+    endToken.lineNumber = currentLineNumber;
+    DEBUG_PRINT_LINE("", DL_SYMBOLS);
 }
 
 bool Tokenizer::hasMoreTokens() {
-    return currentTokenIndex <= tokens.size() - 1;
+    return currentTokenIndex < (int)tokens.size();
 }
 
 void Tokenizer::advance() {
     currentTokenIndex++;
 }
 
-Token Tokenizer::currentToken() {
-    return tokens[currentTokenIndex];
+const Token &Tokenizer::currentToken() {
+    return tokenAt(currentTokenIndex);
+}
+
+const Token &Tokenizer::nextToken() {
+    return tokenAt(currentTokenIndex + 1);
+}
+
+// Indices past the last token return an empty end-of-file token.
+const Token &Tokenizer::tokenAt(int index) {
+    if(index < (int)tokens.size()) {
+        return tokens[index];
+    } else {
+        return endToken;
+    }
+}
+
+int Tokenizer::tokenCount() {
+    return (int)tokens.size();
+}
+
+int Tokenizer::characterCount() {
+    return (int)source.size();
 }
 
-Token Tokenizer::nextToken() {
-    return tokens[currentTokenIndex + 1];
+std::string Tokenizer::tokenText(const Token &token) {
+    return source.substr(token.offset, token.length);
 }
 
 void Tokenizer::printTokens() {
-    for(Token token: tokens) {
-        std::cout << "Line " << token.lineNumber << ": '" << token.token << "' : " << typeToStr(token.type) << std::endl;
+    for(const Token &token: tokens) {
+        std::cout << "Line " << token.lineNumber << ": '" << tokenText(token) << "' : " << typeToStr(token.type) << std::endl;
     }
 }
\ No newline at end of file
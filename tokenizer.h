@@ -4,6 +4,8 @@
 #include <string>
 #include <cctype>
 #include <vector>
+#include "compileerror.h"
+#include "stringtable.h"
 
 enum TokenSubType {
     ST_ALNUM,
@@ -19,29 +21,73 @@ enum TokenType {
     TT_IDENTIFIER
 };
 
+enum Keyword {
+    KW_NONE,
+    KW_CLASS,
+    KW_CONSTRUCTOR,
+    KW_FUNCTION,
+    KW_METHOD,
+    KW_FIELD,
+    KW_STATIC,
+    KW_VAR,
+    KW_INT,
+    KW_CHAR,
+    KW_BOOLEAN,
+    KW_VOID,
+    KW_TRUE,
+    KW_FALSE,
+    KW_NULL,
+    KW_THIS,
+    KW_LET,
+    KW_DO,
+    KW_IF,
+    KW_ELSE,
+    KW_WHILE,
+    KW_RETURN
+};
+
+// Token text is not copied out of the source: a token is a slice
+// (offset and length) of the file contents held by the Tokenizer.
+// id is the interned id of the text in the compilation's StringTable,
+// symbol is the character of a symbol token and 0 for other tokens.
 struct Token {
-    std::string token;
-    int type;
+    int offset;
+    int length;
+    int id;
     int lineNumber;
+    unsigned char type;
+    unsigned char keyword;
+    char symbol;
 };
 
 class Tokenizer {
 
 public:
-    void tokenize(std::string inputFilename);
+    void tokenize(std::string inputFilename, StringTable &stringTable);
+    void tokenizeText(const std::string &text, StringTable &stringTable);
     bool hasMoreTokens();
     void advance();
-    Token currentToken();
-    Token nextToken();
+    const Token &currentToken();
+    const Token &nextToken();
+    const Token &tokenAt(int index);
+    int tokenCount();
+    int characterCount();
+    std::string tokenText(const Token &token);
     void printTokens();
     std::string typeToStr(int type);
 
 private:
+    std::string source;
+    StringTable *strings = nullptr;
     std::vector<Token> tokens;
+    Token endToken = {0, 0, 0, 0, TT_SYMBOL, KW_NONE, 0};
     int currentTokenIndex = 0;
     int currentLineNumber = 1;
 
-    void addCharToken(char c);
-    void addStringToken(std::string token, TokenSubType subType);
+    bool readFile(std::string inputFilename);
+    void scan(StringTable &stringTable);
+    void addCharToken(int offset);
+    void addStringToken(int start, int end, TokenSubType subType);
+    void finishToken(int state, int tokenStart, int offset);
 
 };
\ No newline at end of file
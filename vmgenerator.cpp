@@ -0,0 +1,542 @@
+#include "vmgenerator.h"
+
+VMGenerator::VMGenerator(StringTable &stringTable, VMWriter &writer, bool optimize, const ProgramIndex *program, int inlineThreshold, bool poolStrings): strings(stringTable), vmWriter(writer), optimize(optimize), program(program), inlineThreshold(inlineThreshold), poolStrings(poolStrings) {}
+
+void VMGenerator::defineVariable(int name, int type, SymbolKind kind, int line) {
+    if(!symbolTable.define(name, type, kind)) {
+        throw SemanticError("Line " + std::to_string(line) + ": " + "variable '" + strings.str(name) + "' is already defined");
+    }
+}
+
+const SymbolTableEntry *VMGenerator::findVariable(int name) {
+    const SymbolTableEntry *entry = symbolTable.find(name);
+    if(!entry) {
+        throw SemanticError("Line " + std::to_string(lineNumber) + ": " + "variable '" + strings.str(name) + "' is undefined");
+    }
+    return entry;
+}
+
+// Variables map directly onto VM segments: fields are addressed through
+// the 'this' segment, which points at the current object in methods and
+// constructors.
+VMSegment VMGenerator::kindToSegment(SymbolKind kind) {
+    switch(kind) {
+        case SK_STATIC:   return SEG_STATIC;
+        case SK_FIELD:    return SEG_THIS;
+        case SK_ARGUMENT: return SEG_ARGUMENT;
+        case SK_LOCAL:    return SEG_LOCAL;
+        default:          return SEG_NONE;
+    }
+}
+
+VMSegment VMGenerator::variableSegment(const SymbolTableEntry *entry) {
+    if(entry->kind == SK_FIELD && subroutineKind == KW_FUNCTION) {
+        throw SemanticError("Line " + std::to_string(lineNumber) + ": " + "field '" + strings.str(entry->name) + "' cannot be used in a function");
+    }
+    return kindToSegment(entry->kind);
+}
+
+void VMGenerator::writePush(const SymbolTableEntry *entry) {
+    vmWriter.writePush(variableSegment(entry), entry->index);
+}
+
+void VMGenerator::writePop(const SymbolTableEntry *entry) {
+    vmWriter.writePop(variableSegment(entry), entry->index);
+}
+
+void VMGenerator::generate(ClassDec *classDec) {
+    symbolTable.pushScope();
+    classNameId = classDec->name;
+    className = strings.str(classNameId);
+    compileVarDecs(classDec->classVars);
+    poolStatic = symbolTable.varCount(SK_STATIC);
+    for(SubroutineDec *subroutine = classDec->subroutines; subroutine; subroutine = subroutine->next) {
+        int start = vmWriter.size();
+        calls.push_back(std::vector<int>());
+        compileSubroutine(subroutine);
+        if(optimize && program && !program->isReachable(className + "." + strings.str(subroutine->name))) {
+            vmWriter.truncate(start);
+        }
+    }
+    if(!pooledStrings.empty()) {
+        writeStringPool();
+    }
+}
+
+// Full names of the subroutines called by each subroutine of the class,
+// in the order of the subroutines, including the calls to the OS that
+// the compiler generates.
+const std::vector<std::vector<int>> &VMGenerator::subroutineCalls() {
+    return calls;
+}
+
+const SymbolTableStats &VMGenerator::symbolStats() {
+    return symbolTable.stats();
+}
+
+void VMGenerator::compileVarDecs(VarDec *varDecs) {
+    for(VarDec *varDec = varDecs; varDec; varDec = varDec->next) {
+        SymbolKind kind = varDec->kind == KW_FIELD ? SK_FIELD : varDec->kind == KW_STATIC ? SK_STATIC : SK_LOCAL;
+        for(Name *name = varDec->names; name; name = name->next) {
+            defineVariable(name->id, varDec->type, kind, name->lineNumber);
+        }
+    }
+}
+
+void VMGenerator::compileSubroutine(SubroutineDec *subroutine) {
+    subroutineKind = subroutine->kind;
+    symbolTable.pushScope();
+    if(subroutineKind == KW_METHOD) {
+        defineVariable(KW_THIS, classNameId, SK_ARGUMENT, 0);
+    }
+    for(Parameter *parameter = subroutine->parameters; parameter; parameter = parameter->next) {
+        defineVariable(parameter->name, parameter->type, SK_ARGUMENT, parameter->lineNumber);
+    }
+    compileVarDecs(subroutine->locals);
+    vmWriter.writeFunction(strings.intern(className + "." + strings.str(subroutine->name)), symbolTable.varCount(SK_LOCAL));
+    vmWriter.writeBlank();
+    if(subroutineKind == KW_CONSTRUCTOR) {
+        vmWriter.writePush(SEG_CONSTANT, symbolTable.varCount(SK_FIELD));
+        writeCall(strings.intern("Memory.alloc"), 1);
+        vmWriter.writePop(SEG_POINTER, 0);
+        vmWriter.writeBlank();
+    } else if(subroutineKind == KW_METHOD) {
+        vmWriter.writePush(SEG_ARGUMENT, 0);
+        vmWriter.writePop(SEG_POINTER, 0);
+        vmWriter.writeBlank();
+    }
+    compileStatements(subroutine->statements);
+    symbolTable.popScope();
+    vmWriter.writeBlank();
+    vmWriter.writeBlank();
+    vmWriter.writeBlank();
+}
+
+void VMGenerator::compileStatements(Statement *statements) {
+    for(Statement *statement = statements; statement; statement = statement->next) {
+        lineNumber = statement->lineNumber;
+        switch(statement->kind) {
+            case STMT_LET:    compileLetStatement(statement);       break;
+            case STMT_IF:     compileIfStatement(statement);        break;
+            case STMT_WHILE:  compileWhileStatement(statement);     break;
+            case STMT_DO:     compileDoStatement(statement);        break;
+            case STMT_RETURN: compileReturnStatement(statement);    break;
+        }
+    }
+}
+
+void VMGenerator::compileLetStatement(Statement *statement) {
+    const SymbolTableEntry *entry = findVariable(statement->name);
+    if(statement->hasIndex) {
+        writePush(entry);
+        compileExpression(statement->index);
+        vmWriter.writeArithmetic(VM_ADD);
+    }
+    compileExpression(statement->value);
+    lineNumber = statement->lineNumber;
+    if(statement->hasIndex) {
+        vmWriter.writePop(SEG_TEMP, 0);
+        vmWriter.writePop(SEG_POINTER, 1);
+        vmWriter.writePush(SEG_TEMP, 0);
+        vmWriter.writePop(SEG_THAT, 0);
+    } else {
+        writePop(entry);
+    }
+    vmWriter.writeBlank();
+}
+
+void VMGenerator::compileIfStatement(Statement *statement) {
+    int labelL1 = strings.intern(className + "_ifL1." + std::to_string(runningIndex));
+    int labelL2 = strings.intern(className + "_ifL2." + std::to_string(runningIndex));
+    runningIndex++;
+    compileExpression(statement->value);
+    vmWriter.writeArithmetic(VM_NOT);
+    vmWriter.writeIf(labelL1);
+    vmWriter.writeBlank();
+    compileStatements(statement->body);
+    vmWriter.writeGoto(labelL2);
+    vmWriter.writeLabel(labelL1);
+    vmWriter.writeBlank();
+    compileStatements(statement->elseBody);
+    vmWriter.writeLabel(labelL2);
+    vmWriter.writeBlank();
+}
+
+void VMGenerator::compileWhileStatement(Statement *statement) {
+    int labelL1 = strings.intern(className + "_whileL1." + std::to_string(runningIndex));
+    int labelL2 = strings.intern(className + "_whileL2." + std::to_string(runningIndex));
+    runningIndex++;
+    vmWriter.writeLabel(labelL1);
+    vmWriter.writeBlank();
+    compileExpression(statement->value);
+    vmWriter.writeArithmetic(VM_NOT);
+    vmWriter.writeIf(labelL2);
+    vmWriter.writeBlank();
+    compileStatements(statement->body);
+    vmWriter.writeGoto(labelL1);
+    vmWriter.writeLabel(labelL2);
+    vmWriter.writeBlank();
+}
+
+void VMGenerator::compileDoStatement(Statement *statement) {
+    compileSubroutineCall(statement->call);
+    vmWriter.writePop(SEG_TEMP, 0);
+    vmWriter.writeBlank();
+}
+
+void VMGenerator::compileReturnStatement(Statement *statement) {
+    if(statement->value) {
+        compileExpression(statement->value);
+    } else {
+        vmWriter.writePush(SEG_CONSTANT, 0);
+    }
+    vmWriter.writeReturn();
+    vmWriter.writeBlank();
+}
+
+void VMGenerator::compileExpression(Expression *expression) {
+    if(!expression) {
+        return;
+    }
+    int leftStart = vmWriter.size();
+    compileTerm(expression->term);
+    for(OperatorTerm *rest = expression->rest; rest; rest = rest->next) {
+        int rightStart = vmWriter.size();
+        compileTerm(rest->term);
+        writeOp(rest->symbol, leftStart, rightStart);
+    }
+}
+
+// Returns the number of arguments; empty ones are skipped.
+int VMGenerator::compileExpressionList(ExpressionList *list) {
+    int expressionCount = 0;
+    for(ExpressionList *item = list; item; item = item->next) {
+        if(item->expression) {
+            compileExpression(item->expression);
+            expressionCount++;
+        }
+    }
+    return expressionCount;
+}
+
+void VMGenerator::compileTerm(Term *term) {
+    lineNumber = term->lineNumber;
+    switch(term->kind) {
+        case TERM_INT:
+            vmWriter.writePush(SEG_CONSTANT, term->value);
+            break;
+        case TERM_STRING:
+            if(poolStrings) {
+                writePooledString(term->text);
+            } else {
+                writeString(term->text);
+            }
+            break;
+        case TERM_KEYWORD:
+            if(term->keyword == KW_TRUE) {
+                vmWriter.writePush(SEG_CONSTANT, 1);
+                vmWriter.writeArithmetic(VM_NEG);
+            } else if(term->keyword == KW_THIS) {
+                vmWriter.writePush(SEG_POINTER, 0);
+            } else {
+                vmWriter.writePush(SEG_CONSTANT, 0);
+            }
+            break;
+        case TERM_VARIABLE:
+            writePush(findVariable(term->name));
+            break;
+        case TERM_ARRAY:
+            writePush(findVariable(term->name));
+            compileExpression(term->expression);
+            vmWriter.writeArithmetic(VM_ADD);
+            vmWriter.writePop(SEG_POINTER, 1);
+            vmWriter.writePush(SEG_THAT, 0);
+            break;
+        case TERM_CALL:
+            compileSubroutineCall(term->call);
+            break;
+        case TERM_PARENTHESES:
+            compileExpression(term->expression);
+            break;
+        case TERM_UNARY: {
+            int start = vmWriter.size();
+            compileTerm(term->operand);
+            writeUnaryOp(term->symbol == '-' ? VM_NEG : VM_NOT, start);
+            break;
+        }
+    }
+}
+
+// Returns the signature of the called subroutine, or null if its class is
+// not part of the program or there is no ProgramIndex.
+const SubroutineSignature *VMGenerator::checkCall(SubroutineCall *call, bool throughObject, const std::string &calledClass, const std::string &fullName) {
+    if(!program || !program->hasClass(calledClass)) {
+        return nullptr;
+    }
+    std::string line = "Line " + std::to_string(call->lineNumber) + ": ";
+    const SubroutineSignature *signature = program->find(fullName);
+    if(!signature) {
+        throw SemanticError(line + "subroutine '" + fullName + "' is undefined");
+    }
+    if(throughObject && signature->kind != KW_METHOD) {
+        throw SemanticError(line + "'" + fullName + "' is not a method");
+    }
+    if(call->className && !throughObject && signature->kind == KW_METHOD) {
+        throw SemanticError(line + "method '" + fullName + "' must be called on an object");
+    }
+    if(!call->className && signature->kind == KW_METHOD && subroutineKind == KW_FUNCTION) {
+        throw SemanticError(line + "method '" + fullName + "' cannot be called from a function");
+    }
+    int argumentCount = 0;
+    for(ExpressionList *item = call->arguments; item; item = item->next) {
+        if(item->expression) {
+            argumentCount++;
+        }
+    }
+    if(argumentCount != signature->parameterCount) {
+        throw SemanticError(line + "'" + fullName + "' expects " + std::to_string(signature->parameterCount) + " arguments, got " + std::to_string(argumentCount));
+    }
+    return signature;
+}
+
+// A call with a qualifier that names a variable is a method call on that
+// object; otherwise the qualifier is a class name. Calls without a
+// qualifier are method calls on this in methods and constructors, unless
+// the ProgramIndex says that the called subroutine is a function.
+void VMGenerator::compileSubroutineCall(SubroutineCall *call) {
+    lineNumber = call->lineNumber;
+    const SymbolTableEntry *entry = nullptr;
+    std::string typeStr = className;
+    if(call->className) {
+        entry = symbolTable.find(call->className);
+        typeStr = strings.str(entry ? entry->type : call->className);
+    }
+    std::string fullName = typeStr + "." + strings.str(call->name);
+    const SubroutineSignature *signature = checkCall(call, entry != nullptr, typeStr, fullName);
+    int parameterCount = 0;
+    if(entry) {
+        writePush(entry);
+        parameterCount = 1;
+    } else if(!call->className) {
+        bool passThis = signature ? signature->kind == KW_METHOD : subroutineKind == KW_METHOD || subroutineKind == KW_CONSTRUCTOR;
+        if(passThis) {
+            parameterCount = 1;
+            vmWriter.writePush(SEG_POINTER, 0);
+        }
+    }
+    parameterCount += compileExpressionList(call->arguments);
+    int function = strings.intern(fullName);
+    if(optimize && signature && signature->inlinable && (int)signature->inlineBody.size() <= inlineThreshold && parameterCount <= VMWriter::inlineArgumentLimit) {
+        calls.back().push_back(function);
+        vmWriter.writeInline(signature->inlineBody, parameterCount, signature->kind == KW_METHOD);
+    } else {
+        writeCall(function, parameterCount);
+    }
+}
+
+// Writes a call and records it for the subroutine being compiled, so that
+// the call graph also has the OS calls that the compiler itself generates.
+void VMGenerator::writeCall(int function, int argumentCount) {
+    calls.back().push_back(function);
+    vmWriter.writeCall(function, argumentCount);
+}
+
+// Builds a new string with the text of a literal.
+void VMGenerator::writeString(int text) {
+    std::string characters = strings.str(text);
+    int appendChar = strings.intern("String.appendChar");
+    vmWriter.writePush(SEG_CONSTANT, (int)characters.size());
+    writeCall(strings.intern("String.new"), 1);
+    for(char c: characters) {
+        vmWriter.writePush(SEG_CONSTANT, c);
+        writeCall(appendChar, 2);
+    }
+    vmWriter.writeBlank();
+}
+
+// Reads a literal from the string pool of the class, calling the function
+// that builds the pool when the pool static is still null.
+void VMGenerator::writePooledString(int text) {
+    auto pooled = stringPool.insert({text, (int)pooledStrings.size()});
+    if(pooled.second) {
+        pooledStrings.push_back(text);
+    }
+    int label = strings.intern(className + "_strL." + std::to_string(runningIndex));
+    runningIndex++;
+    vmWriter.writePush(SEG_STATIC, poolStatic);
+    vmWriter.writeIf(label);
+    writeCall(strings.intern(className + ".$strings"), 0);
+    // Class.$strings is not in the ProgramIndex, so the calls it makes are
+    // recorded for the subroutines that may run it.
+    calls.back().push_back(strings.intern("Array.new"));
+    calls.back().push_back(strings.intern("String.new"));
+    calls.back().push_back(strings.intern("String.appendChar"));
+    vmWriter.writePop(SEG_TEMP, 0);
+    vmWriter.writeLabel(label);
+    vmWriter.writePush(SEG_STATIC, poolStatic);
+    if(pooled.first->second != 0) {
+        vmWriter.writePush(SEG_CONSTANT, pooled.first->second);
+        vmWriter.writeArithmetic(VM_ADD);
+    }
+    vmWriter.writePop(SEG_POINTER, 1);
+    vmWriter.writePush(SEG_THAT, 0);
+}
+
+// The function that fills the string pool, stored like "let pool[i] = ...".
+// Its calls are listed after those of the subroutines of the class.
+void VMGenerator::writeStringPool() {
+    calls.push_back(std::vector<int>());
+    vmWriter.writeFunction(strings.intern(className + ".$strings"), 0);
+    vmWriter.writeBlank();
+    vmWriter.writePush(SEG_CONSTANT, (int)pooledStrings.size());
+    writeCall(strings.intern("Array.new"), 1);
+    vmWriter.writePop(SEG_STATIC, poolStatic);
+    vmWriter.writeBlank();
+    for(int i = 0; i < (int)pooledStrings.size(); i++) {
+        vmWriter.writePush(SEG_STATIC, poolStatic);
+        vmWriter.writePush(SEG_CONSTANT, i);
+        vmWriter.writeArithmetic(VM_ADD);
+        writeString(pooledStrings[i]);
+        vmWriter.writePop(SEG_TEMP, 0);
+        vmWriter.writePop(SEG_POINTER, 1);
+        vmWriter.writePush(SEG_TEMP, 0);
+        vmWriter.writePop(SEG_THAT, 0);
+    }
+    vmWriter.writeBlank();
+    vmWriter.writePush(SEG_CONSTANT, 0);
+    vmWriter.writeReturn();
+    vmWriter.writeBlank();
+    vmWriter.writeBlank();
+    vmWriter.writeBlank();
+}
+
+// Evaluates a binary operator on two constants with the 16-bit arithmetic
+// of the VM. Division by zero is left to Math.divide to report.
+static bool foldOp(char op, int left, int right, int &result) {
+    switch(op) {
+        case '+': result = (short)(left + right); return true;
+        case '-': result = (short)(left - right); return true;
+        case '*': result = (short)(left * right); return true;
+        case '/':
+            if(right == 0 || (left == -32768 && right == -1)) {
+                return false;
+            }
+            result = left / right;
+            return true;
+        case '&': result = (short)(left & right); return true;
+        case '|': result = (short)(left | right); return true;
+        case '<': result = left < right ? -1 : 0; return true;
+        case '>': result = left > right ? -1 : 0; return true;
+        case '=': result = left == right ? -1 : 0; return true;
+    }
+    return false;
+}
+
+// Returns k for a multiplier 2^k that is cheaper as k doublings than as a
+// call to Math.multiply, otherwise -1.
+static int doublingCount(int value) {
+    for(int k = 1; k <= 4; k++) {
+        if(value == 1 << k) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+// Whether "x op constant" is just x.
+static bool isRightIdentity(char op, int value) {
+    return (value == 0 && (op == '+' || op == '-' || op == '|')) || (value == 1 && (op == '*' || op == '/')) || (value == -1 && op == '&');
+}
+
+// Whether "constant op x" is just x.
+static bool isLeftIdentity(char op, int value) {
+    return (value == 0 && (op == '+' || op == '|')) || (value == 1 && op == '*') || (value == -1 && op == '&');
+}
+
+// Multiplies the value on top of the stack by 2^count using additions.
+void VMGenerator::writeDoubling(int count) {
+    for(int i = 0; i < count; i++) {
+        vmWriter.writePop(SEG_TEMP, 0);
+        vmWriter.writePush(SEG_TEMP, 0);
+        vmWriter.writePush(SEG_TEMP, 0);
+        vmWriter.writeArithmetic(VM_ADD);
+    }
+}
+
+// Rewrites the operands of a binary operator that are constants: the left
+// operand was written from leftStart and the right one from rightStart to
+// the end of the command list. Operands that are not constants are kept
+// as they are, since they may have side effects. Returns false if the
+// operator still has to be written.
+bool VMGenerator::foldConstants(char op, int leftStart, int rightStart) {
+    int left, right, result;
+    bool leftConstant = vmWriter.constantIn(leftStart, rightStart, left);
+    bool rightConstant = vmWriter.constantIn(rightStart, vmWriter.size(), right);
+    if(leftConstant && rightConstant) {
+        if(!foldOp(op, left, right, result)) {
+            return false;
+        }
+        vmWriter.truncate(leftStart);
+        vmWriter.writeConstant(result);
+        return true;
+    }
+    if(rightConstant) {
+        if(isRightIdentity(op, right)) {
+            vmWriter.truncate(rightStart);
+            return true;
+        }
+        if(op == '*' && (right == -1 || doublingCount(right) > 0)) {
+            vmWriter.truncate(rightStart);
+            if(right == -1) {
+                vmWriter.writeArithmetic(VM_NEG);
+            } else {
+                writeDoubling(doublingCount(right));
+            }
+            return true;
+        }
+    }
+    if(leftConstant) {
+        if(isLeftIdentity(op, left)) {
+            vmWriter.erase(leftStart, rightStart);
+            return true;
+        }
+        if((op == '-' && left == 0) || (op == '*' && left == -1)) {
+            vmWriter.erase(leftStart, rightStart);
+            vmWriter.writeArithmetic(VM_NEG);
+            return true;
+        }
+        if(op == '*' && doublingCount(left) > 0) {
+            vmWriter.erase(leftStart, rightStart);
+            writeDoubling(doublingCount(left));
+            return true;
+        }
+    }
+    return false;
+}
+
+void VMGenerator::writeUnaryOp(VMOpcode opcode, int start) {
+    int value;
+    if(optimize && vmWriter.constantIn(start, vmWriter.size(), value)) {
+        vmWriter.truncate(start);
+        vmWriter.writeConstant(opcode == VM_NEG ? (short)-value : (short)~value);
+        return;
+    }
+    vmWriter.writeArithmetic(opcode);
+}
+
+void VMGenerator::writeOp(char op, int leftStart, int rightStart) {
+    if(optimize && foldConstants(op, leftStart, rightStart)) {
+        return;
+    }
+    switch(op) {
+        case '+': vmWriter.writeArithmetic(VM_ADD);                       break;
+        case '-': vmWriter.writeArithmetic(VM_SUB);                       break;
+        case '*': writeCall(strings.intern("Math.multiply"), 2); break;
+        case '/': writeCall(strings.intern("Math.divide"), 2);   break;
+        case '&': vmWriter.writeArithmetic(VM_AND);                       break;
+        case '|': vmWriter.writeArithmetic(VM_OR);                        break;
+        case '<': vmWriter.writeArithmetic(VM_LT);                        break;
+        case '>': vmWriter.writeArithmetic(VM_GT);                        break;
+        case '=': vmWriter.writeArithmetic(VM_EQ);                        break;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ast.h"
+#include "compileerror.h"
+#include "programindex.h"
+#include "stringtable.h"
+#include "symboltable.h"
+#include "tokenizer.h"
+#include "vmwriter.h"
+
+// Generates the VM code of a class from its syntax tree into a VMWriter.
+// Semantic errors, such as undefined variables, are thrown as
+// SemanticError. With optimize set, expressions on constants are folded
+// while they are generated. With a ProgramIndex, calls to classes of the
+// program are checked against their signatures, which also decides whether
+// an unqualified call passes this, and subroutines that the index marks
+// as unreachable are left out of the output when optimizing. Calls to leaf
+// subroutines with at most inlineThreshold commands are then inlined.
+// With poolStrings, each distinct string literal of the class is built
+// once, on first use, by the function Class.$strings into an array kept in
+// a static variable, and uses read it from there. Jack strings are
+// mutable, so this is only correct for programs that do not change their
+// literals.
+class VMGenerator {
+
+public:
+    VMGenerator(StringTable &stringTable, VMWriter &writer, bool optimize, const ProgramIndex *program = nullptr, int inlineThreshold = 0, bool poolStrings = false);
+    void generate(ClassDec *classDec);
+    const std::vector<std::vector<int>> &subroutineCalls();
+    const SymbolTableStats &symbolStats();
+
+private:
+    StringTable &strings;
+    VMWriter &vmWriter;
+    bool optimize;
+    const ProgramIndex *program;
+    int inlineThreshold;
+    bool poolStrings;
+    int poolStatic = 0;
+    std::unordered_map<int, int> stringPool;
+    std::vector<int> pooledStrings;
+    SymbolTable symbolTable;
+    int subroutineKind = KW_NONE;
+    std::string className;
+    int classNameId = 0;
+    int runningIndex = 0;
+    int lineNumber = 0;
+    std::vector<std::vector<int>> calls;
+
+    void defineVariable(int name, int type, SymbolKind kind, int line);
+    const SymbolTableEntry *findVariable(int name);
+    VMSegment kindToSegment(SymbolKind kind);
+    VMSegment variableSegment(const SymbolTableEntry *entry);
+    void writePush(const SymbolTableEntry *entry);
+    void writePop(const SymbolTableEntry *entry);
+    void compileVarDecs(VarDec *varDecs);
+    void compileSubroutine(SubroutineDec *subroutine);
+    void compileStatements(Statement *statements);
+    void compileLetStatement(Statement *statement);
+    void compileIfStatement(Statement *statement);
+    void compileWhileStatement(Statement *statement);
+    void compileDoStatement(Statement *statement);
+    void compileReturnStatement(Statement *statement);
+    void compileExpression(Expression *expression);
+    int compileExpressionList(ExpressionList *list);
+    void compileTerm(Term *term);
+    void compileSubroutineCall(SubroutineCall *call);
+    void writeCall(int function, int argumentCount);
+    void writeString(int text);
+    void writePooledString(int text);
+    void writeStringPool();
+    const SubroutineSignature *checkCall(SubroutineCall *call, bool throughObject, const std::string &calledClass, const std::string &fullName);
+    void writeOp(char op, int leftStart, int rightStart);
+    void writeUnaryOp(VMOpcode opcode, int start);
+    bool foldConstants(char op, int leftStart, int rightStart);
+    void writeDoubling(int count);
+
+};
\ No newline at end of file
@@ -0,0 +1,533 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "vmrunner.h"
+
+static const int ramSize = 32768;
+static const int stackBase = 256;
+static const int staticEnd = 256;
+static const int heapBase = 2048;
+static const int heapEnd = 16384;
+
+struct NativeEntry {
+    const char *name;
+    int argumentCount;
+};
+
+// Indexed by NativeFunction, starting at NF_MEMORY_ALLOC.
+static const NativeEntry nativeEntries[] = {
+    {"Memory.alloc", 1}, {"Memory.deAlloc", 1}, {"Array.new", 1}, {"Array.dispose", 1},
+    {"Math.multiply", 2}, {"Math.divide", 2}, {"Math.abs", 1}, {"Math.min", 2}, {"Math.max", 2}, {"Math.sqrt", 1},
+    {"String.new", 1}, {"String.dispose", 1}, {"String.length", 1}, {"String.charAt", 2}, {"String.setCharAt", 3},
+    {"String.appendChar", 2}, {"String.eraseLastChar", 1}, {"String.intValue", 1}, {"String.setInt", 2},
+    {"String.backSpace", 0}, {"String.doubleQuote", 0}, {"String.newLine", 0},
+    {"Output.printChar", 1}, {"Output.printString", 1}, {"Output.printInt", 1}, {"Output.println", 0},
+    {"Output.backSpace", 0}, {"Output.moveCursor", 2},
+    {"Sys.halt", 0}, {"Sys.error", 1}, {"Sys.wait", 1}
+};
+
+VMRunner::VMRunner(std::ostream &output): output(output) {}
+
+int VMRunner::findFunction(const std::string &name) {
+    auto it = functionIndex.find(name);
+    if(it != functionIndex.end()) {
+        return it->second;
+    }
+    functions.push_back({name, -1, NF_NONE, 0});
+    functionIndex[name] = (int)functions.size() - 1;
+    return (int)functions.size() - 1;
+}
+
+// Appends the functions of a VM file to the program. Labels are local to
+// their function, and the statics of each file get their own addresses.
+void VMRunner::load(const std::string &filename) {
+    std::ifstream stream(filename);
+    if(!stream.is_open()) {
+        throw VMError("cannot open " + filename);
+    }
+    std::unordered_map<std::string, int> labels;
+    std::vector<std::pair<int, std::string>> jumps;
+    int staticCount = 0;
+    int function = -1;
+    std::string line;
+    int lineNumber = 0;
+    while(std::getline(stream, line)) {
+        lineNumber++;
+        size_t comment = line.find("//");
+        if(comment != std::string::npos) {
+            line.erase(comment);
+        }
+        std::istringstream words(line);
+        std::string command;
+        if(!(words >> command)) {
+            continue;
+        }
+        std::string where = filename + ":" + std::to_string(lineNumber) + ": ";
+        int opcode = VM_PUSH;
+        while(opcode <= VM_RETURN && command != opcodeNames[opcode]) {
+            opcode++;
+        }
+        if(opcode > VM_RETURN) {
+            throw VMError(where + "unknown command '" + command + "'");
+        }
+        Instruction instruction = {(VMOpcode)opcode, SEG_NONE, 0, -1};
+        std::string name;
+        if(opcode != VM_FUNCTION && function < 0) {
+            throw VMError(where + "'" + command + "' outside of a function");
+        }
+        switch(opcode) {
+            case VM_PUSH:
+            case VM_POP: {
+                int segment = SEG_CONSTANT;
+                if(!(words >> name >> instruction.arg)) {
+                    throw VMError(where + "'" + command + "' needs a segment and an index");
+                }
+                while(segment < SEG_NONE && name != segmentNames[segment]) {
+                    segment++;
+                }
+                instruction.segment = (VMSegment)segment;
+                int arg = instruction.arg;
+                if(segment == SEG_NONE || arg < 0 || (segment == SEG_CONSTANT && (opcode == VM_POP || arg > 32767)) ||
+                   (segment == SEG_POINTER && arg > 1) || (segment == SEG_TEMP && arg > 7)) {
+                    throw VMError(where + "invalid operand '" + name + " " + std::to_string(arg) + "'");
+                }
+                if(segment == SEG_STATIC) {
+                    staticCount = std::max(staticCount, arg + 1);
+                    instruction.arg = nextStatic + arg;
+                }
+                break;
+            }
+            case VM_LABEL:
+                if(!(words >> name)) {
+                    throw VMError(where + "label needs a name");
+                }
+                labels[functions[function].name + "$" + name] = (int)code.size();
+                continue;
+            case VM_GOTO:
+            case VM_IF_GOTO:
+                if(!(words >> name)) {
+                    throw VMError(where + "'" + command + "' needs a label");
+                }
+                jumps.push_back({(int)code.size(), functions[function].name + "$" + name});
+                break;
+            case VM_FUNCTION:
+            case VM_CALL:
+                if(!(words >> name >> instruction.arg) || instruction.arg < 0) {
+                    throw VMError(where + "'" + command + "' needs a name and a count");
+                }
+                instruction.target = findFunction(name);
+                if(opcode == VM_FUNCTION) {
+                    function = instruction.target;
+                    if(functions[function].start >= 0) {
+                        throw VMError(where + "function '" + name + "' is already defined");
+                    }
+                    functions[function].start = (int)code.size();
+                }
+                break;
+        }
+        code.push_back(instruction);
+        functionOf.push_back(function);
+    }
+    for(const auto &jump: jumps) {
+        auto label = labels.find(jump.second);
+        if(label == labels.end()) {
+            throw VMError(filename + ": label '" + jump.second.substr(jump.second.find('$') + 1) + "' is undefined");
+        }
+        code[jump.first].target = label->second;
+    }
+    nextStatic += staticCount;
+    if(nextStatic > staticEnd) {
+        throw VMError(filename + ": too many static variables");
+    }
+}
+
+// Binds the functions the program calls but does not define to the OS
+// stubs.
+void VMRunner::link() {
+    for(Function &function: functions) {
+        if(function.start >= 0) {
+            continue;
+        }
+        function.native = NF_NONE;
+        for(int i = 0; i < (int)(sizeof(nativeEntries) / sizeof(nativeEntries[0])); i++) {
+            if(function.name == nativeEntries[i].name) {
+                function.native = (NativeFunction)(NF_MEMORY_ALLOC + i);
+            }
+        }
+        if(function.native == NF_NONE) {
+            throw VMError("function '" + function.name + "' is undefined");
+        }
+    }
+}
+
+int VMRunner::address(const Instruction &instruction) {
+    int result;
+    switch(instruction.segment) {
+        case SEG_LOCAL:    result = ram[1] + instruction.arg; break;
+        case SEG_ARGUMENT: result = ram[2] + instruction.arg; break;
+        case SEG_THIS:     result = ram[3] + instruction.arg; break;
+        case SEG_THAT:     result = ram[4] + instruction.arg; break;
+        case SEG_POINTER:  return 3 + instruction.arg;
+        case SEG_TEMP:     return 5 + instruction.arg;
+        default:           return instruction.arg;
+    }
+    return checkAddress(result, segmentNames[instruction.segment]);
+}
+
+// SP, LCL, ARG, THIS and THAT are ordinary RAM cells that a program can
+// overwrite, so every address computed from them is checked before use.
+int VMRunner::checkAddress(int address, const std::string &what) {
+    if(address < 0 || address >= ramSize) {
+        throw VMError("address " + std::to_string(address) + " of " + what + " is out of range");
+    }
+    return address;
+}
+
+void VMRunner::push(int value) {
+    if(ram[0] >= heapBase) {
+        throw VMError("stack overflow");
+    }
+    if(ram[0] < stackBase) {
+        throw VMError("stack pointer " + std::to_string(ram[0]) + " is below the stack");
+    }
+    ram[ram[0]++] = (short)value;
+}
+
+short VMRunner::pop() {
+    if(ram[0] <= stackBase) {
+        throw VMError("stack underflow");
+    }
+    return ram[--ram[0]];
+}
+
+// Objects are never freed, as in the simplest Jack OS.
+int VMRunner::allocate(int size) {
+    if(size < 0 || size > heapEnd - heapTop) {
+        throw VMError("cannot allocate " + std::to_string(size) + " words");
+    }
+    int block = heapTop;
+    heapTop += std::max(size, 1);
+    return block;
+}
+
+// Strings are blocks of the maximum length, the length and the characters.
+// The header is checked too, since the program can overwrite it.
+int VMRunner::checkString(int string) {
+    if(string < heapBase || string + 1 >= heapTop || ram[string + 1] < 0 || ram[string + 1] > ram[string] || string + 2 + ram[string] > heapTop) {
+        throw VMError(std::to_string(string) + " is not a string");
+    }
+    return string;
+}
+
+// Newline and backspace are the Jack character set's 128 and 129.
+void VMRunner::writeChar(int c) {
+    if(c == 128) {
+        output << '\n';
+    } else if(c == 129) {
+        output << '\b';
+    } else {
+        output << (char)c;
+    }
+}
+
+short VMRunner::callNative(const Function &function, const short *args, int argumentCount) {
+    if(argumentCount != nativeEntries[function.native - NF_MEMORY_ALLOC].argumentCount) {
+        throw VMError("'" + function.name + "' expects " + std::to_string(nativeEntries[function.native - NF_MEMORY_ALLOC].argumentCount) + " arguments, got " + std::to_string(argumentCount));
+    }
+    switch(function.native) {
+        case NF_MEMORY_ALLOC:
+        case NF_ARRAY_NEW:
+            return (short)allocate(args[0]);
+        case NF_MATH_MULTIPLY:
+            return (short)(args[0] * args[1]);
+        case NF_MATH_DIVIDE:
+            if(args[1] == 0) {
+                throw VMError("division by zero");
+            }
+            return (short)(args[0] / args[1]);
+        case NF_MATH_ABS:
+            return (short)std::abs(args[0]);
+        case NF_MATH_MIN:
+            return std::min(args[0], args[1]);
+        case NF_MATH_MAX:
+            return std::max(args[0], args[1]);
+        case NF_MATH_SQRT: {
+            if(args[0] < 0) {
+                throw VMError("square root of a negative number");
+            }
+            int root = 0;
+            while((root + 1) * (root + 1) <= args[0]) {
+                root++;
+            }
+            return (short)root;
+        }
+        case NF_STRING_NEW: {
+            if(args[0] < 0) {
+                throw VMError("string length " + std::to_string(args[0]) + " is negative");
+            }
+            int string = allocate(args[0] + 2);
+            ram[string] = args[0];
+            ram[string + 1] = 0;
+            return (short)string;
+        }
+        case NF_STRING_LENGTH:
+            return ram[checkString(args[0]) + 1];
+        case NF_STRING_CHAR_AT:
+        case NF_STRING_SET_CHAR_AT: {
+            int string = checkString(args[0]);
+            if(args[1] < 0 || args[1] >= ram[string + 1]) {
+                throw VMError("string index " + std::to_string(args[1]) + " is out of range");
+            }
+            if(function.native == NF_STRING_SET_CHAR_AT) {
+                ram[string + 2 + args[1]] = args[2];
+                return 0;
+            }
+            return ram[string + 2 + args[1]];
+        }
+        case NF_STRING_APPEND_CHAR: {
+            int string = checkString(args[0]);
+            if(ram[string + 1] >= ram[string]) {
+                throw VMError("string is full");
+            }
+            ram[string + 2 + ram[string + 1]++] = args[1];
+            return (short)string;
+        }
+        case NF_STRING_ERASE_LAST_CHAR: {
+            int string = checkString(args[0]);
+            if(ram[string + 1] > 0) {
+                ram[string + 1]--;
+            }
+            return 0;
+        }
+        case NF_STRING_INT_VALUE: {
+            int string = checkString(args[0]);
+            int value = 0;
+            bool negative = ram[string + 1] > 0 && ram[string + 2] == '-';
+            for(int i = negative ? 1 : 0; i < ram[string + 1] && ram[string + 2 + i] >= '0' && ram[string + 2 + i] <= '9'; i++) {
+                value = value * 10 + ram[string + 2 + i] - '0';
+            }
+            return (short)(negative ? -value : value);
+        }
+        case NF_STRING_SET_INT: {
+            int string = checkString(args[0]);
+            std::string digits = std::to_string(args[1]);
+            if((int)digits.size() > ram[string]) {
+                throw VMError("string is full");
+            }
+            for(size_t i = 0; i < digits.size(); i++) {
+                ram[string + 2 + i] = digits[i];
+            }
+            ram[string + 1] = (short)digits.size();
+            return 0;
+        }
+        case NF_STRING_BACKSPACE:
+            return 129;
+        case NF_STRING_DOUBLE_QUOTE:
+            return '"';
+        case NF_STRING_NEWLINE:
+            return 128;
+        case NF_OUTPUT_PRINT_CHAR:
+            writeChar(args[0]);
+            return 0;
+        case NF_OUTPUT_PRINT_STRING: {
+            int string = checkString(args[0]);
+            for(int i = 0; i < ram[string + 1]; i++) {
+                writeChar(ram[string + 2 + i]);
+            }
+            return 0;
+        }
+        case NF_OUTPUT_PRINT_INT:
+            output << args[0];
+            return 0;
+        case NF_OUTPUT_PRINTLN:
+            output << '\n';
+            return 0;
+        case NF_SYS_HALT:
+            halted = true;
+            return 0;
+        case NF_SYS_ERROR:
+            throw VMError("Sys.error(" + std::to_string(args[0]) + ")");
+        default:
+            return 0;
+    }
+}
+
+// Runs Sys.init, or Main.main if the program has no Sys.init, until it
+// returns or calls Sys.halt. Returns the number of executed instructions.
+long long VMRunner::run(long long instructionLimit) {
+    link();
+    auto entry = functionIndex.find("Sys.init");
+    if(entry == functionIndex.end() || functions[entry->second].start < 0) {
+        entry = functionIndex.find("Main.main");
+    }
+    if(entry == functionIndex.end() || functions[entry->second].start < 0) {
+        throw VMError("the program has no Sys.init or Main.main");
+    }
+    ram.assign(ramSize, 0);
+    executed.assign(code.size(), 0);
+    returnStack.clear();
+    for(Function &function: functions) {
+        function.calls = 0;
+    }
+    heapTop = heapBase;
+    halted = false;
+
+    // The entry function is called from outside the program and returns
+    // to instruction -1. Return addresses are kept on the host, so their
+    // slot in the frame is left 0.
+    ram[0] = stackBase;
+    for(int i = 0; i < 5; i++) {
+        push(0);
+    }
+    ram[1] = ram[0];
+    ram[2] = ram[0] - 5;
+    returnStack.push_back(-1);
+    functions[entry->second].calls++;
+    int pc = functions[entry->second].start;
+    long long count = 0;
+    int current = pc;
+    // A function is only entered by a call. Without a return, execution
+    // would run on into the next function or past the end of the code.
+    bool called = true;
+    try {
+        while(pc >= 0 && !halted) {
+            if(count == instructionLimit) {
+                throw VMError("stopped after " + std::to_string(count) + " instructions");
+            }
+            if(pc >= (int)code.size() || (code[pc].opcode == VM_FUNCTION && !called)) {
+                throw VMError("reached the end of the function without a return");
+            }
+            called = false;
+            current = pc;
+            const Instruction &instruction = code[pc];
+            executed[pc]++;
+            count++;
+            pc++;
+            switch(instruction.opcode) {
+                case VM_PUSH:
+                    push(instruction.segment == SEG_CONSTANT ? instruction.arg : ram[address(instruction)]);
+                    break;
+                case VM_POP: {
+                    int target = address(instruction);
+                    ram[target] = pop();
+                    break;
+                }
+                case VM_ADD: { short b = pop(); push(pop() + b); break; }
+                case VM_SUB: { short b = pop(); push(pop() - b); break; }
+                case VM_AND: { short b = pop(); push(pop() & b); break; }
+                case VM_OR:  { short b = pop(); push(pop() | b); break; }
+                case VM_EQ:  { short b = pop(); push(pop() == b ? -1 : 0); break; }
+                case VM_GT:  { short b = pop(); push(pop() > b ? -1 : 0); break; }
+                case VM_LT:  { short b = pop(); push(pop() < b ? -1 : 0); break; }
+                case VM_NEG: push(-pop()); break;
+                case VM_NOT: push(~pop()); break;
+                case VM_GOTO:
+                    pc = instruction.target;
+                    break;
+                case VM_IF_GOTO:
+                    if(pop() != 0) {
+                        pc = instruction.target;
+                    }
+                    break;
+                case VM_FUNCTION:
+                    for(int i = 0; i < instruction.arg; i++) {
+                        push(0);
+                    }
+                    break;
+                case VM_CALL: {
+                    Function &callee = functions[instruction.target];
+                    int argumentCount = instruction.arg;
+                    callee.calls++;
+                    if(ram[0] - argumentCount < stackBase) {
+                        throw VMError("stack underflow");
+                    }
+                    if(callee.start < 0) {
+                        ram[0] -= argumentCount;
+                        push(callNative(callee, &ram[ram[0]], argumentCount));
+                        break;
+                    }
+                    returnStack.push_back(pc);
+                    push(0);
+                    push(ram[1]);
+                    push(ram[2]);
+                    push(ram[3]);
+                    push(ram[4]);
+                    ram[2] = ram[0] - 5 - argumentCount;
+                    ram[1] = ram[0];
+                    pc = callee.start;
+                    called = true;
+                    break;
+                }
+                case VM_RETURN: {
+                    int frame = checkAddress(ram[1] - 4, "the frame") + 4;
+                    int result = checkAddress(ram[2], "the return value");
+                    ram[result] = pop();
+                    ram[0] = result + 1;
+                    ram[4] = ram[frame - 1];
+                    ram[3] = ram[frame - 2];
+                    ram[2] = ram[frame - 3];
+                    ram[1] = ram[frame - 4];
+                    pc = returnStack.back();
+                    returnStack.pop_back();
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    } catch(const VMError &e) {
+        throw VMError("in " + functions[functionOf[current]].name + ": " + e.what());
+    }
+    return count;
+}
+
+// Functions that ran or were called, most executed instructions first.
+std::vector<FunctionProfile> VMRunner::profile() {
+    std::vector<long long> instructions(functions.size(), 0);
+    for(size_t i = 0; i < executed.size(); i++) {
+        instructions[functionOf[i]] += executed[i];
+    }
+    std::vector<FunctionProfile> result;
+    for(size_t i = 0; i < functions.size(); i++) {
+        if(functions[i].calls > 0 || instructions[i] > 0) {
+            result.push_back({functions[i].name, functions[i].start < 0, instructions[i], functions[i].calls});
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const FunctionProfile &a, const FunctionProfile &b) {
+        if(a.instructions != b.instructions) {
+            return a.instructions > b.instructions;
+        }
+        if(a.calls != b.calls) {
+            return a.calls > b.calls;
+        }
+        return a.name < b.name;
+    });
+    return result;
+}
+
+// Writes the hot-spot table of the last run with at most rowCount rows.
+void VMRunner::writeProfile(std::ostream &report, int rowCount) {
+    std::vector<FunctionProfile> functionProfiles = profile();
+    long long total = 0;
+    long long calls = 0;
+    for(const FunctionProfile &function: functionProfiles) {
+        total += function.instructions;
+        calls += function.calls;
+    }
+    report << "Executed " << total << " instructions, " << calls << " calls" << std::endl;
+    char line[256];
+    std::snprintf(line, sizeof(line), "%14s %7s %10s  %s", "instructions", "%", "calls", "function");
+    report << line << std::endl;
+    for(int i = 0; i < (int)functionProfiles.size() && i < rowCount; i++) {
+        const FunctionProfile &function = functionProfiles[i];
+        if(function.native) {
+            std::snprintf(line, sizeof(line), "%14s %7s %10lld  %s (os)", "-", "-", function.calls, function.name.c_str());
+        } else {
+            std::snprintf(line, sizeof(line), "%14lld %6.1f%% %10lld  %s", function.instructions,
+                          total ? 100.0 * function.instructions / total : 0.0, function.calls, function.name.c_str());
+        }
+        report << line << std::endl;
+    }
+}
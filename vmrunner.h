@@ -0,0 +1,129 @@
+#pragma once
+
+#include <exception>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "vmwriter.h"
+
+// Raised when a VM file cannot be loaded and when the program fails while
+// it runs, for example on a stack overflow or a call of an unknown
+// function.
+struct VMError : public std::exception {
+
+public:
+    VMError(std::string msg): message(msg) {}
+    const char *what() const throw() {
+        return message.c_str();
+    }
+
+private:
+    std::string message;
+
+};
+
+// Executed instructions of a function and the number of times it was
+// called. OS functions run on the host and execute no instructions.
+struct FunctionProfile {
+    std::string name;
+    bool native;
+    long long instructions;
+    long long calls;
+};
+
+// Interpreter for the VM code the compiler writes, with the memory layout
+// of the Hack platform: pointers in RAM 0..4, temp at 5, statics from 16,
+// the stack from 256 and the heap from 2048. The OS classes that generated
+// code relies on (Memory, Array, Math, String, Output and Sys) are stubs on
+// the host, unless the program defines them itself; Output writes to the
+// given stream. Labels, calls and static addresses are resolved when the
+// files are loaded, and every executed instruction is counted for the
+// function it belongs to.
+class VMRunner {
+
+public:
+    VMRunner(std::ostream &output = std::cout);
+    void load(const std::string &filename);
+    long long run(long long instructionLimit);
+    std::vector<FunctionProfile> profile();
+    void writeProfile(std::ostream &report, int rowCount);
+
+private:
+    enum NativeFunction {
+        NF_NONE,
+        NF_MEMORY_ALLOC,
+        NF_MEMORY_DEALLOC,
+        NF_ARRAY_NEW,
+        NF_ARRAY_DISPOSE,
+        NF_MATH_MULTIPLY,
+        NF_MATH_DIVIDE,
+        NF_MATH_ABS,
+        NF_MATH_MIN,
+        NF_MATH_MAX,
+        NF_MATH_SQRT,
+        NF_STRING_NEW,
+        NF_STRING_DISPOSE,
+        NF_STRING_LENGTH,
+        NF_STRING_CHAR_AT,
+        NF_STRING_SET_CHAR_AT,
+        NF_STRING_APPEND_CHAR,
+        NF_STRING_ERASE_LAST_CHAR,
+        NF_STRING_INT_VALUE,
+        NF_STRING_SET_INT,
+        NF_STRING_BACKSPACE,
+        NF_STRING_DOUBLE_QUOTE,
+        NF_STRING_NEWLINE,
+        NF_OUTPUT_PRINT_CHAR,
+        NF_OUTPUT_PRINT_STRING,
+        NF_OUTPUT_PRINT_INT,
+        NF_OUTPUT_PRINTLN,
+        NF_OUTPUT_BACKSPACE,
+        NF_OUTPUT_MOVE_CURSOR,
+        NF_SYS_HALT,
+        NF_SYS_ERROR,
+        NF_SYS_WAIT
+    };
+
+    // arg is the RAM address of static, the index of other segments and
+    // the argument or local count of call and function. target is the
+    // instruction of goto and if-goto and the function of call.
+    struct Instruction {
+        VMOpcode opcode;
+        VMSegment segment;
+        int arg;
+        int target;
+    };
+
+    // start is -1 for functions that the program does not define.
+    struct Function {
+        std::string name;
+        int start;
+        NativeFunction native;
+        long long calls;
+    };
+
+    std::ostream &output;
+    std::vector<Instruction> code;
+    std::vector<int> functionOf;
+    std::vector<long long> executed;
+    std::vector<int> returnStack;
+    std::vector<Function> functions;
+    std::unordered_map<std::string, int> functionIndex;
+    std::vector<short> ram;
+    int nextStatic = 16;
+    int heapTop = 2048;
+    bool halted = false;
+
+    int findFunction(const std::string &name);
+    void link();
+    int address(const Instruction &instruction);
+    int checkAddress(int address, const std::string &what);
+    void push(int value);
+    short pop();
+    int allocate(int size);
+    short callNative(const Function &function, const short *args, int argumentCount);
+    int checkString(int string);
+    void writeChar(int c);
+
+};
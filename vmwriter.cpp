@@ -0,0 +1,349 @@
+#include "vmwriter.h"
+
+const char *const segmentNames[] = {"constant", "argument", "local", "static", "this", "that", "pointer", "temp"};
+const char *const opcodeNames[] = {"push", "pop", "add", "sub", "neg", "eq", "gt", "lt", "and", "or", "not",
+                                    "label", "goto", "if-goto", "function", "call", "return", ""};
+
+VMWriter::VMWriter(StringTable &stringTable): strings(stringTable) {}
+
+void VMWriter::add(VMOpcode opcode, VMSegment segment, int arg, int name) {
+    commands.push_back({opcode, segment, arg, name});
+}
+
+void VMWriter::writePush(VMSegment segment, int index) {
+    add(VM_PUSH, segment, index, 0);
+}
+
+void VMWriter::writePop(VMSegment segment, int index) {
+    add(VM_POP, segment, index, 0);
+}
+
+void VMWriter::writeArithmetic(VMOpcode opcode) {
+    add(opcode, SEG_NONE, 0, 0);
+}
+
+void VMWriter::writeLabel(int label) {
+    add(VM_LABEL, SEG_NONE, 0, label);
+}
+
+void VMWriter::writeGoto(int label) {
+    add(VM_GOTO, SEG_NONE, 0, label);
+}
+
+void VMWriter::writeIf(int label) {
+    add(VM_IF_GOTO, SEG_NONE, 0, label);
+}
+
+void VMWriter::writeCall(int function, int argumentCount) {
+    add(VM_CALL, SEG_NONE, argumentCount, function);
+}
+
+void VMWriter::writeFunction(int function, int localCount) {
+    add(VM_FUNCTION, SEG_NONE, localCount, function);
+}
+
+void VMWriter::writeReturn() {
+    add(VM_RETURN, SEG_NONE, 0, 0);
+}
+
+void VMWriter::writeBlank() {
+    add(VM_BLANK, SEG_NONE, 0, 0);
+}
+
+// Writes a 16-bit value, using neg or not for negative values since the
+// constant segment only holds 0..32767.
+void VMWriter::writeConstant(int value) {
+    if(value >= 0) {
+        writePush(SEG_CONSTANT, value);
+    } else if(value == -32768) {
+        writePush(SEG_CONSTANT, 32767);
+        writeArithmetic(VM_NOT);
+    } else {
+        writePush(SEG_CONSTANT, -value);
+        writeArithmetic(VM_NEG);
+    }
+}
+
+// Writes the body of a leaf subroutine taken from leafBody() in place of a
+// call to it. The arguments on the stack are moved to temp 1 and up, and a
+// method reaches its object through that, so the this of the caller is
+// left alone. The body leaves its result on the stack as the call would.
+void VMWriter::writeInline(const std::vector<VMCommand> &body, int argumentCount, bool method) {
+    for(int i = argumentCount; i >= 1; i--) {
+        writePop(SEG_TEMP, i);
+    }
+    for(VMCommand command: body) {
+        if(command.segment == SEG_ARGUMENT) {
+            command.segment = SEG_TEMP;
+            command.arg++;
+        } else if(method && command.segment == SEG_THIS) {
+            command.segment = SEG_THAT;
+        } else if(method && command.segment == SEG_POINTER) {
+            command.arg = 1;
+        }
+        commands.push_back(command);
+    }
+}
+
+// Copies the body of the function whose function command is at start,
+// without the return, if it can be inlined: it has no locals, no calls and
+// no branches, ends in its only return and does not use static, which
+// belongs to its own class. A method must also leave that and pointer 1
+// alone, since they stand in for its this when it is inlined.
+bool VMWriter::leafBody(int start, bool method, std::vector<VMCommand> &body) {
+    body.clear();
+    if(commands[start].arg != 0) {
+        return false;
+    }
+    for(int i = start + 1; i < (int)commands.size(); i++) {
+        const VMCommand &command = commands[i];
+        switch(command.opcode) {
+            case VM_BLANK:
+            case VM_NONE:
+                break;
+            case VM_RETURN:
+                i = nextCommand(i);
+                return i == (int)commands.size() || commands[i].opcode == VM_FUNCTION;
+            case VM_LABEL:
+            case VM_GOTO:
+            case VM_IF_GOTO:
+            case VM_FUNCTION:
+            case VM_CALL:
+                return false;
+            default:
+                if(command.segment == SEG_STATIC || command.segment == SEG_LOCAL || (command.segment == SEG_TEMP && command.arg != 0)) {
+                    return false;
+                }
+                if(method && (command.segment == SEG_THAT || (command.segment == SEG_POINTER && command.arg == 1))) {
+                    return false;
+                }
+                body.push_back(command);
+        }
+    }
+    return false;
+}
+
+// Checks whether the commands from start to end are exactly a constant as
+// the compiler writes it: "push constant n", optionally followed by neg
+// or not.
+bool VMWriter::constantIn(int start, int end, int &value) {
+    int length = end - start;
+    if(length < 1 || length > 2 || commands[start].opcode != VM_PUSH || commands[start].segment != SEG_CONSTANT) {
+        return false;
+    }
+    value = commands[start].arg;
+    if(length == 2) {
+        if(commands[start + 1].opcode == VM_NEG) {
+            value = (short)-value;
+        } else if(commands[start + 1].opcode == VM_NOT) {
+            value = (short)~value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int VMWriter::size() {
+    return (int)commands.size();
+}
+
+void VMWriter::truncate(int size) {
+    commands.resize(size);
+}
+
+void VMWriter::erase(int start, int end) {
+    commands.erase(commands.begin() + start, commands.begin() + end);
+}
+
+void VMWriter::clear() {
+    commands.clear();
+}
+
+std::vector<VMCommand> &VMWriter::getCommands() {
+    return commands;
+}
+
+void VMWriter::write(OutputBuffer &output) {
+    std::string line;
+    for(const VMCommand &command: commands) {
+        if(command.opcode == VM_NONE) {
+            continue;
+        }
+        line = opcodeNames[command.opcode];
+        switch(command.opcode) {
+            case VM_PUSH:
+            case VM_POP:
+                line += ' ';
+                line += segmentNames[command.segment];
+                line += ' ';
+                line += std::to_string(command.arg);
+                break;
+            case VM_LABEL:
+            case VM_GOTO:
+            case VM_IF_GOTO:
+                line += ' ';
+                line.append(strings.text(command.name), strings.length(command.name));
+                break;
+            case VM_FUNCTION:
+            case VM_CALL:
+                line += ' ';
+                line.append(strings.text(command.name), strings.length(command.name));
+                line += ' ';
+                line += std::to_string(command.arg);
+                break;
+            default:
+                break;
+        }
+        output.writeLine(line);
+    }
+}
+
+// Index of the first command after index that is not a blank line or
+// removed, or the size of the list.
+int VMWriter::nextCommand(int index) {
+    index++;
+    while(index < (int)commands.size() && (commands[index].opcode == VM_BLANK || commands[index].opcode == VM_NONE)) {
+        index++;
+    }
+    return index;
+}
+
+// Recognizes "push constant n" optionally followed by neg or not, the
+// shapes the compiler produces for constants. end is the index of the
+// last command of the constant.
+bool VMWriter::constantAt(int index, int &value, int &end) {
+    if(index >= (int)commands.size() || commands[index].opcode != VM_PUSH || commands[index].segment != SEG_CONSTANT) {
+        return false;
+    }
+    value = commands[index].arg;
+    end = index;
+    int next = nextCommand(index);
+    if(next < (int)commands.size()) {
+        if(commands[next].opcode == VM_NEG) {
+            value = (short)-value;
+            end = next;
+        } else if(commands[next].opcode == VM_NOT) {
+            value = (short)~value;
+            end = next;
+        }
+    }
+    return true;
+}
+
+int VMWriter::constantLength(int value) {
+    return value >= 0 ? 1 : 2;
+}
+
+// Writes the commands for a 16-bit value into the slots first and second.
+// second is only used for negative values.
+void VMWriter::writeConstantAt(int first, int second, int value) {
+    if(value >= 0) {
+        commands[first] = {VM_PUSH, SEG_CONSTANT, value, 0};
+    } else if(value == -32768) {
+        commands[first] = {VM_PUSH, SEG_CONSTANT, 32767, 0};
+        commands[second] = {VM_NOT, SEG_NONE, 0, 0};
+    } else {
+        commands[first] = {VM_PUSH, SEG_CONSTANT, -value, 0};
+        commands[second] = {VM_NEG, SEG_NONE, 0, 0};
+    }
+}
+
+// Removes the commands from first to last, keeping blank lines.
+void VMWriter::remove(int first, int last) {
+    for(int i = first; i <= last; i++) {
+        if(commands[i].opcode != VM_BLANK) {
+            commands[i].opcode = VM_NONE;
+        }
+    }
+}
+
+// Applies the first rule that matches the commands starting at index.
+// Every rule makes the list shorter, so repeated application terminates.
+bool VMWriter::simplify(int index) {
+    int size = (int)commands.size();
+    VMCommand &command = commands[index];
+    int next = nextCommand(index);
+    int value, end;
+
+    // push x; pop x
+    if(command.opcode == VM_PUSH && command.segment != SEG_CONSTANT && next < size &&
+       commands[next].opcode == VM_POP && commands[next].segment == command.segment && commands[next].arg == command.arg) {
+        remove(index, next);
+        return true;
+    }
+
+    // not; not
+    if(command.opcode == VM_NOT && next < size && commands[next].opcode == VM_NOT) {
+        remove(index, next);
+        return true;
+    }
+
+    // constant followed by not, neg or if-goto
+    if(constantAt(index, value, end)) {
+        int after = nextCommand(end);
+        if(after < size) {
+            VMOpcode opcode = commands[after].opcode;
+            int count = end == index ? 1 : 2;
+            if(opcode == VM_NOT || opcode == VM_NEG) {
+                int folded = opcode == VM_NOT ? (short)~value : (short)-value;
+                if(constantLength(folded) <= count) {
+                    remove(index, after);
+                    writeConstantAt(index, end, folded);
+                    return true;
+                }
+            } else if(opcode == VM_IF_GOTO) {
+                int label = commands[after].name;
+                remove(index, after);
+                if(value != 0) {
+                    commands[index] = {VM_GOTO, SEG_NONE, 0, label};
+                }
+                return true;
+            }
+        }
+    }
+
+    if(command.opcode == VM_GOTO || command.opcode == VM_RETURN) {
+        // goto L directly followed by label L
+        if(command.opcode == VM_GOTO) {
+            for(int i = next; i < size && commands[i].opcode == VM_LABEL; i = nextCommand(i)) {
+                if(commands[i].name == command.name) {
+                    remove(index, index);
+                    return true;
+                }
+            }
+        }
+        // unreachable commands up to the next label
+        int last = index;
+        for(int i = next; i < size && commands[i].opcode != VM_LABEL && commands[i].opcode != VM_FUNCTION; i = nextCommand(i)) {
+            last = i;
+        }
+        if(last != index) {
+            remove(next, last);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Peephole pass over the collected commands. Blank lines are ignored when
+// matching, so the layout of the output is kept.
+void VMWriter::optimize() {
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(int i = nextCommand(-1); i < (int)commands.size(); i = nextCommand(i)) {
+            if(simplify(i)) {
+                changed = true;
+            }
+        }
+        int kept = 0;
+        for(const VMCommand &command: commands) {
+            if(command.opcode != VM_NONE) {
+                commands[kept++] = command;
+            }
+        }
+        commands.resize(kept);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "outputbuffer.h"
+#include "stringtable.h"
+
+enum VMOpcode {
+    VM_PUSH,
+    VM_POP,
+    VM_ADD,
+    VM_SUB,
+    VM_NEG,
+    VM_EQ,
+    VM_GT,
+    VM_LT,
+    VM_AND,
+    VM_OR,
+    VM_NOT,
+    VM_LABEL,
+    VM_GOTO,
+    VM_IF_GOTO,
+    VM_FUNCTION,
+    VM_CALL,
+    VM_RETURN,
+    VM_BLANK,
+    VM_NONE
+};
+
+enum VMSegment {
+    SEG_CONSTANT,
+    SEG_ARGUMENT,
+    SEG_LOCAL,
+    SEG_STATIC,
+    SEG_THIS,
+    SEG_THAT,
+    SEG_POINTER,
+    SEG_TEMP,
+    SEG_NONE
+};
+
+// Names of the opcodes and segments in VM files, indexed by the enums.
+extern const char *const opcodeNames[];
+extern const char *const segmentNames[];
+
+// arg is the index of push/pop, the argument count of call and the local
+// count of function. name is the StringTable id of a label or function.
+// VM_BLANK is an empty line in the output, VM_NONE a removed command.
+struct VMCommand {
+    VMOpcode opcode;
+    VMSegment segment;
+    int arg;
+    int name;
+};
+
+// Collects the VM commands of a class so they can be optimized before
+// they are written out.
+class VMWriter {
+
+public:
+    // Inlined code keeps its arguments in temp 1 and up; the compiler
+    // itself only uses temp 0.
+    static const int inlineArgumentLimit = 7;
+
+    VMWriter(StringTable &stringTable);
+    void writePush(VMSegment segment, int index);
+    void writePop(VMSegment segment, int index);
+    void writeArithmetic(VMOpcode opcode);
+    void writeLabel(int label);
+    void writeGoto(int label);
+    void writeIf(int label);
+    void writeCall(int function, int argumentCount);
+    void writeFunction(int function, int localCount);
+    void writeReturn();
+    void writeBlank();
+    void writeConstant(int value);
+    void writeInline(const std::vector<VMCommand> &body, int argumentCount, bool method);
+    bool leafBody(int start, bool method, std::vector<VMCommand> &body);
+    bool constantIn(int start, int end, int &value);
+    int size();
+    void truncate(int size);
+    void erase(int start, int end);
+    void optimize();
+    void write(OutputBuffer &output);
+    void clear();
+    std::vector<VMCommand> &getCommands();
+
+private:
+    StringTable &strings;
+    std::vector<VMCommand> commands;
+
+    void add(VMOpcode opcode, VMSegment segment, int arg, int name);
+    int nextCommand(int index);
+    bool constantAt(int index, int &value, int &end);
+    int constantLength(int value);
+    void writeConstantAt(int first, int second, int value);
+    void remove(int first, int last);
+    bool simplify(int index);
+
+};
\ No newline at end of file
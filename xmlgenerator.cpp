@@ -0,0 +1,241 @@
+#include "xmlgenerator.h"
+
+XMLGenerator::XMLGenerator(StringTable &stringTable, OutputBuffer &output): strings(stringTable), xml(output) {}
+
+void XMLGenerator::writeKeyword(int keyword) {
+    xml.leaf("keyword", strings.text(keyword), strings.length(keyword));
+}
+
+void XMLGenerator::writeSymbol(char symbol) {
+    xml.leaf("symbol", symbol);
+}
+
+void XMLGenerator::writeIdentifier(int name) {
+    xml.leaf("identifier", strings.text(name), strings.length(name));
+}
+
+// The ids of the keywords come first in the StringTable, so a type id is
+// either one of them or the name of a class.
+void XMLGenerator::writeType(int type) {
+    if(type > KW_NONE && type <= KW_RETURN) {
+        writeKeyword(type);
+    } else {
+        writeIdentifier(type);
+    }
+}
+
+static const char *tokenTypeNames[] = {"keyword", "symbol", "integerConstant", "stringConstant", "identifier"};
+
+// Writes the token list of a file without structure, as the tokenizer
+// stage of the nand2tetris syntax analyzer does.
+void XMLGenerator::generateTokens(Tokenizer &tokenizer) {
+    xml.openElement("tokens");
+    for(int i = 0; i < tokenizer.tokenCount(); i++) {
+        const Token &token = tokenizer.tokenAt(i);
+        std::string text = tokenizer.tokenText(token);
+        xml.leaf(tokenTypeNames[token.type], text.data(), (int)text.size());
+    }
+    xml.closeElement();
+}
+
+void XMLGenerator::generate(ClassDec *classDec) {
+    xml.openElement("class");
+    writeKeyword(KW_CLASS);
+    writeIdentifier(classDec->name);
+    writeSymbol('{');
+    for(VarDec *varDec = classDec->classVars; varDec; varDec = varDec->next) {
+        writeVarDec(varDec, "classVarDec");
+    }
+    for(SubroutineDec *subroutine = classDec->subroutines; subroutine; subroutine = subroutine->next) {
+        writeSubroutineDec(subroutine);
+    }
+    writeSymbol('}');
+    xml.closeElement();
+}
+
+void XMLGenerator::writeVarDec(VarDec *varDec, const char *element) {
+    xml.openElement(element);
+    writeKeyword(varDec->kind);
+    writeType(varDec->type);
+    for(Name *name = varDec->names; name; name = name->next) {
+        if(name != varDec->names) {
+            writeSymbol(',');
+        }
+        writeIdentifier(name->id);
+    }
+    writeSymbol(';');
+    xml.closeElement();
+}
+
+void XMLGenerator::writeSubroutineDec(SubroutineDec *subroutine) {
+    xml.openElement("subroutineDec");
+    writeKeyword(subroutine->kind);
+    writeType(subroutine->returnType);
+    writeIdentifier(subroutine->name);
+    writeSymbol('(');
+    writeParameterList(subroutine->parameters);
+    writeSymbol(')');
+    xml.openElement("subroutineBody");
+    writeSymbol('{');
+    for(VarDec *varDec = subroutine->locals; varDec; varDec = varDec->next) {
+        writeVarDec(varDec, "varDec");
+    }
+    writeStatements(subroutine->statements);
+    writeSymbol('}');
+    xml.closeElement();
+    xml.closeElement();
+}
+
+void XMLGenerator::writeParameterList(Parameter *parameters) {
+    xml.openElement("parameterList");
+    for(Parameter *parameter = parameters; parameter; parameter = parameter->next) {
+        if(parameter != parameters) {
+            writeSymbol(',');
+        }
+        writeType(parameter->type);
+        writeIdentifier(parameter->name);
+    }
+    xml.closeElement();
+}
+
+void XMLGenerator::writeStatements(Statement *statements) {
+    xml.openElement("statements");
+    for(Statement *statement = statements; statement; statement = statement->next) {
+        writeStatement(statement);
+    }
+    xml.closeElement();
+}
+
+void XMLGenerator::writeStatement(Statement *statement) {
+    switch(statement->kind) {
+        case STMT_LET:
+            xml.openElement("letStatement");
+            writeKeyword(KW_LET);
+            writeIdentifier(statement->name);
+            if(statement->hasIndex) {
+                writeSymbol('[');
+                writeExpression(statement->index);
+                writeSymbol(']');
+            }
+            writeSymbol('=');
+            writeExpression(statement->value);
+            writeSymbol(';');
+            xml.closeElement();
+            break;
+        case STMT_IF:
+            xml.openElement("ifStatement");
+            writeKeyword(KW_IF);
+            writeSymbol('(');
+            writeExpression(statement->value);
+            writeSymbol(')');
+            writeSymbol('{');
+            writeStatements(statement->body);
+            writeSymbol('}');
+            if(statement->hasElse) {
+                writeKeyword(KW_ELSE);
+                writeSymbol('{');
+                writeStatements(statement->elseBody);
+                writeSymbol('}');
+            }
+            xml.closeElement();
+            break;
+        case STMT_WHILE:
+            xml.openElement("whileStatement");
+            writeKeyword(KW_WHILE);
+            writeSymbol('(');
+            writeExpression(statement->value);
+            writeSymbol(')');
+            writeSymbol('{');
+            writeStatements(statement->body);
+            writeSymbol('}');
+            xml.closeElement();
+            break;
+        case STMT_DO:
+            xml.openElement("doStatement");
+            writeKeyword(KW_DO);
+            writeSubroutineCall(statement->call);
+            writeSymbol(';');
+            xml.closeElement();
+            break;
+        case STMT_RETURN:
+            xml.openElement("returnStatement");
+            writeKeyword(KW_RETURN);
+            writeExpression(statement->value);
+            writeSymbol(';');
+            xml.closeElement();
+            break;
+    }
+}
+
+// Empty expressions have no element.
+void XMLGenerator::writeExpression(Expression *expression) {
+    if(!expression) {
+        return;
+    }
+    xml.openElement("expression");
+    writeTerm(expression->term);
+    for(OperatorTerm *rest = expression->rest; rest; rest = rest->next) {
+        writeSymbol(rest->symbol);
+        writeTerm(rest->term);
+    }
+    xml.closeElement();
+}
+
+void XMLGenerator::writeExpressionList(ExpressionList *list) {
+    xml.openElement("expressionList");
+    for(ExpressionList *item = list; item; item = item->next) {
+        if(item != list) {
+            writeSymbol(',');
+        }
+        writeExpression(item->expression);
+    }
+    xml.closeElement();
+}
+
+void XMLGenerator::writeTerm(Term *term) {
+    xml.openElement("term");
+    switch(term->kind) {
+        case TERM_INT:
+            xml.leaf("integerConstant", strings.text(term->text), strings.length(term->text));
+            break;
+        case TERM_STRING:
+            xml.leaf("stringConstant", strings.text(term->text), strings.length(term->text));
+            break;
+        case TERM_KEYWORD:
+            writeKeyword(term->keyword);
+            break;
+        case TERM_VARIABLE:
+            writeIdentifier(term->name);
+            break;
+        case TERM_ARRAY:
+            writeIdentifier(term->name);
+            writeSymbol('[');
+            writeExpression(term->expression);
+            writeSymbol(']');
+            break;
+        case TERM_CALL:
+            writeSubroutineCall(term->call);
+            break;
+        case TERM_PARENTHESES:
+            writeSymbol('(');
+            writeExpression(term->expression);
+            writeSymbol(')');
+            break;
+        case TERM_UNARY:
+            writeSymbol(term->symbol);
+            writeTerm(term->operand);
+            break;
+    }
+    xml.closeElement();
+}
+
+void XMLGenerator::writeSubroutineCall(SubroutineCall *call) {
+    if(call->className) {
+        writeIdentifier(call->className);
+        writeSymbol('.');
+    }
+    writeIdentifier(call->name);
+    writeSymbol('(');
+    writeExpressionList(call->arguments);
+    writeSymbol(')');
+}
\ No newline at end of file
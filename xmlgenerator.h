@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include "ast.h"
+#include "outputbuffer.h"
+#include "stringtable.h"
+#include "tokenizer.h"
+#include "xmlwriter.h"
+
+// Writes the parse tree of a class as XML, one element per grammar rule
+// with the tokens as leaves, in the format of the nand2tetris syntax
+// analyzer.
+class XMLGenerator {
+
+public:
+    XMLGenerator(StringTable &stringTable, OutputBuffer &output);
+    void generate(ClassDec *classDec);
+    void generateTokens(Tokenizer &tokenizer);
+
+private:
+    StringTable &strings;
+    XMLWriter xml;
+
+    void writeKeyword(int keyword);
+    void writeSymbol(char symbol);
+    void writeIdentifier(int name);
+    void writeType(int type);
+    void writeVarDec(VarDec *varDec, const char *element);
+    void writeSubroutineDec(SubroutineDec *subroutine);
+    void writeParameterList(Parameter *parameters);
+    void writeStatements(Statement *statements);
+    void writeStatement(Statement *statement);
+    void writeExpression(Expression *expression);
+    void writeExpressionList(ExpressionList *list);
+    void writeTerm(Term *term);
+    void writeSubroutineCall(SubroutineCall *call);
+
+};
\ No newline at end of file
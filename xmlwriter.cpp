@@ -0,0 +1,67 @@
+#include "xmlwriter.h"
+
+// Replacement for every character that cannot appear as is in XML text,
+// null for the others.
+struct EscapeTable {
+    const char *entries[256] = {};
+    EscapeTable() {
+        entries['<'] = "&lt;";
+        entries['>'] = "&gt;";
+        entries['"'] = "&quot;";
+        entries['&'] = "&amp;";
+    }
+};
+
+static const EscapeTable escapeTable;
+
+XMLWriter::XMLWriter(OutputBuffer &output): output(output) {}
+
+void XMLWriter::startLine() {
+    line.assign(elements.size() * 2, ' ');
+}
+
+void XMLWriter::appendTag(const char *name, bool closing) {
+    line += closing ? "</" : "<";
+    line += name;
+    line += '>';
+}
+
+void XMLWriter::appendEscaped(const char *text, int length) {
+    for(int i = 0; i < length; i++) {
+        const char *entry = escapeTable.entries[(unsigned char)text[i]];
+        if(entry) {
+            line += entry;
+        } else {
+            line += text[i];
+        }
+    }
+}
+
+void XMLWriter::openElement(const char *name) {
+    startLine();
+    appendTag(name, false);
+    output.writeLine(line);
+    elements.push_back(name);
+}
+
+void XMLWriter::closeElement() {
+    const char *name = elements.back();
+    elements.pop_back();
+    startLine();
+    appendTag(name, true);
+    output.writeLine(line);
+}
+
+void XMLWriter::leaf(const char *name, const char *text, int length) {
+    startLine();
+    appendTag(name, false);
+    line += ' ';
+    appendEscaped(text, length);
+    line += ' ';
+    appendTag(name, true);
+    output.writeLine(line);
+}
+
+void XMLWriter::leaf(const char *name, char text) {
+    leaf(name, &text, 1);
+}
\ No newline at end of file
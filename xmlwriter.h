@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "outputbuffer.h"
+
+// Writes indented XML into an OutputBuffer one line at a time. Elements
+// with children are opened and closed explicitly; leaf() writes an element
+// holding only text on a single line. Indentation follows the number of
+// open elements, and text is escaped as it is copied.
+class XMLWriter {
+
+public:
+    XMLWriter(OutputBuffer &output);
+    void openElement(const char *name);
+    void closeElement();
+    void leaf(const char *name, const char *text, int length);
+    void leaf(const char *name, char text);
+
+private:
+    OutputBuffer &output;
+    std::vector<const char *> elements;
+    std::string line;
+
+    void startLine();
+    void appendTag(const char *name, bool closing);
+    void appendEscaped(const char *text, int length);
+
+};
\ No newline at end of file